@@ -30,6 +30,7 @@
 #include "Pathfinding.h"
 #include "../Engine/RNG.h"
 #include "../Engine/Logger.h"
+#include "../Engine/Profiler.h"
 #include "../Engine/Game.h"
 #include "../Mod/Armor.h"
 #include "../Mod/Mod.h"
@@ -125,6 +126,7 @@ YAML::Node AIModule::save() const
  */
 void AIModule::think(BattleAction *action)
 {
+	Profiler profile(Profiler::PROFILE_AI);
 	action->type = BA_RETHINK;
 	action->actor = _unit;
 	action->weapon = _unit->getMainHandWeapon(false);
@@ -133,13 +135,18 @@ void AIModule::think(BattleAction *action)
 	_attackAction->weapon = action->weapon;
 	_attackAction->number = action->number;
 	_escapeAction->number = action->number;
+	_save->getTileEngine()->validateSpotterCache(); // lines of fire are shared with the other AI units until something moves
+	_save->getTileEngine()->getInfluenceMap()->update();
 	_knownEnemies = countKnownTargets();
 	_visibleEnemies = selectNearestTarget();
 	_spottingEnemies = getSpottingUnits(_unit->getPosition());
 	_melee = _unit->getUtilityWeapon(BT_MELEE) != 0;
 	_rifle = false;
 	_blaster = false;
-	_reachable = _save->getPathfinding()->findReachable(_unit, BattleActionCost());
+	if (!_save->getBattleGame()->getSpeculativeReach(_unit, _reachable))
+	{
+		_save->getPathfinding()->findReachable(_unit, BattleActionCost(), _reachable);
+	}
 	_wasHitBy.clear();
 
 	if (_unit->getCharging() && _unit->getCharging()->isOut())
@@ -187,18 +194,18 @@ void AIModule::think(BattleAction *action)
 				if (action->weapon->getCurrentWaypoints() != 0)
 				{
 					_blaster = true;
-					_reachableWithAttack = _save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_AIMEDSHOT, _unit, action->weapon));
+					_save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_AIMEDSHOT, _unit, action->weapon), _reachableWithAttack);
 				}
 				else
 				{
 					_rifle = true;
-					_reachableWithAttack = _save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_SNAPSHOT, _unit, action->weapon));
+					_save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_SNAPSHOT, _unit, action->weapon), _reachableWithAttack);
 				}
 			}
 			else if (rule->getBattleType() == BT_MELEE)
 			{
 				_melee = true;
-				_reachableWithAttack = _save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_HIT, _unit, action->weapon));
+				_save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_HIT, _unit, action->weapon), _reachableWithAttack);
 			}
 		}
 		else
@@ -402,6 +409,17 @@ bool AIModule::getWasHitBy(int attacker) const
 {
 	return std::find(_wasHitBy.begin(), _wasHitBy.end(), attacker) != _wasHitBy.end();
 }
+
+/**
+ * Sets the faction the unit goes after, for units
+ * that don't fight the player's soldiers.
+ * @param faction Target faction.
+ */
+void AIModule::setTargetFaction(UnitFaction faction)
+{
+	_targetFaction = faction;
+}
+
 /*
  * Sets up a patrol action.
  * this is mainly going from node to node, moving about the map.
@@ -531,16 +549,18 @@ void AIModule::setupPatrol()
 			}
 		}
 
+		// nodes the patrol search already reached don't need another path search
+		bool reachable = false;
 		if (_toNode == 0)
 		{
-			_toNode = _save->getPatrolNode(scout, _unit, _fromNode);
+			_toNode = _save->getPatrolNode(scout, _unit, _fromNode, &reachable);
 			if (_toNode == 0)
 			{
-				_toNode = _save->getPatrolNode(!scout, _unit, _fromNode);
+				_toNode = _save->getPatrolNode(!scout, _unit, _fromNode, &reachable);
 			}
 		}
 
-		if (_toNode != 0)
+		if (_toNode != 0 && !reachable)
 		{
 			_save->getPathfinding()->calculate(_unit, _toNode->getPosition());
 			if (_save->getPathfinding()->getStartDirection() == -1)
@@ -582,8 +602,11 @@ void AIModule::setupAmbush()
 	{
 		const int BASE_SYSTEMATIC_SUCCESS = 100;
 		const int COVER_BONUS = 25;
+		const int COVER_SIDE_BONUS = 2;
+		const int DANGER_PENALTY = 20;
 		const int FAST_PASS_THRESHOLD = 80;
 		Position origin = _save->getTileEngine()->getSightOriginVoxel(_aggroTarget);
+		InfluenceMap *influence = _save->getTileEngine()->getInfluenceMap();
 
 		// we'll use node positions for this, as it gives map makers a good degree of control over how the units will use the environment.
 		for (std::vector<Node*>::const_iterator i = _save->getNodes()->begin(); i != _save->getNodes()->end(); ++i)
@@ -595,7 +618,7 @@ void AIModule::setupAmbush()
 			Position pos = (*i)->getPosition();
 			Tile *tile = _save->getTile(pos);
 			if (tile == 0 || _save->getTileEngine()->distance(pos, _unit->getPosition()) > 10 || pos.z != _unit->getPosition().z || tile->getDangerous() ||
-				std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
+				!_reachableWithAttack.isReachable(_save->getTileIndex(pos)))
 				continue; // just ignore unreachable tiles
 
 			if (_traceAI)
@@ -606,16 +629,17 @@ void AIModule::setupAmbush()
 			}
 
 			// make sure we can't be seen here.
-			Position target;
-			if (!_save->getTileEngine()->canTargetUnit(&origin, tile, &target, _aggroTarget, _unit) && !getSpottingUnits(pos))
+			if (!_save->getTileEngine()->canTargetUnitCached(&origin, tile, _aggroTarget, _unit) && !getSpottingUnits(pos))
 			{
-				_save->getPathfinding()->calculate(_unit, pos);
-				int ambushTUs = _save->getPathfinding()->getTotalTUCost();
+				int ambushTUs = _reachableWithAttack.getTUCost(_save->getTileIndex(pos));
 				// make sure we can move here
-				if (_save->getPathfinding()->getStartDirection() != -1)
+				if (pos != _unit->getPosition())
 				{
 					int score = BASE_SYSTEMATIC_SUCCESS;
 					score -= ambushTUs;
+					// keep out of reach of blasts we know about, and prefer tiles walled in on more sides
+					score -= influence->getDanger(pos) * DANGER_PENALTY;
+					score += influence->getCover(pos) * COVER_SIDE_BONUS;
 
 					// make sure our enemy can reach here too.
 					_save->getPathfinding()->calculate(_aggroTarget, pos);
@@ -790,10 +814,14 @@ void AIModule::setupEscape()
 	// weights of various factors in choosing a tile to which to withdraw
 	const int EXPOSURE_PENALTY = 10;
 	const int FIRE_PENALTY = 40;
+	const int COVER_SIDE_BONUS = 2;
+	const int DANGER_PENALTY = 20;
 	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int BASE_DESPERATE_SUCCESS = 110;
 	const int FAST_PASS_THRESHOLD = 100; // a score that's good enough to quit the while loop early; it's subjective, hand-tuned and may need tweaking
 
+	InfluenceMap *influence = _save->getTileEngine()->getInfluenceMap();
+
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
 
@@ -883,7 +911,7 @@ void AIModule::setupEscape()
 		else
 		{
 			spotters = getSpottingUnits(_escapeAction->target);
-			if (std::find(_reachable.begin(), _reachable.end(), _save->getTileIndex(_escapeAction->target))  == _reachable.end())
+			if (!_reachable.isReachable(_save->getTileIndex(_escapeAction->target)))
 				continue; // just ignore unreachable tiles
 
 			if (_spottingEnemies || spotters)
@@ -905,6 +933,9 @@ void AIModule::setupEscape()
 			{
 				score -= BASE_SYSTEMATIC_SUCCESS;
 			}
+			// blasts that can't reach the tile itself still make it a bad place to be
+			score -= influence->getDanger(_escapeAction->target) * DANGER_PENALTY;
+			score += influence->getCover(_escapeAction->target) * COVER_SIDE_BONUS;
 
 			if (_traceAI)
 			{
@@ -917,13 +948,13 @@ void AIModule::setupEscape()
 
 		if (tile && score > bestTileScore)
 		{
-			// calculate TUs to tile; we could be getting this from findReachable() somehow but that would break something for sure...
-			_save->getPathfinding()->calculate(_unit, _escapeAction->target);
-			if (_escapeAction->target == _unit->getPosition() || _save->getPathfinding()->getStartDirection() != -1)
+			// TUs to tile, as found by findReachable()
+			int escapeTUs = _reachable.getTUCost(_save->getTileIndex(_escapeAction->target));
+			if (escapeTUs != -1)
 			{
 				bestTileScore = score;
 				bestTile = _escapeAction->target;
-				_escapeTUs = _save->getPathfinding()->getTotalTUCost();
+				_escapeTUs = escapeTUs;
 				if (_escapeAction->target == _unit->getPosition())
 				{
 					_escapeTUs = 1;
@@ -935,7 +966,6 @@ void AIModule::setupEscape()
 					tile->setTUMarker(score);
 				}
 			}
-			_save->getPathfinding()->abortPath();
 			if (bestTileScore > FAST_PASS_THRESHOLD) coverFound = true; // good enough, gogogo
 		}
 	}
@@ -995,6 +1025,11 @@ int AIModule::getSpottingUnits(const Position& pos) const
 	// if we don't actually occupy the position being checked, we need to do a virtual LOF check.
 	bool checking = pos != _unit->getPosition();
 	int tally = 0;
+	// nobody we could be looking out for is close enough, skip all the lines of sight
+	if (_save->getTileEngine()->getInfluenceMap()->getThreat(_targetFaction, pos) == 0)
+	{
+		return tally;
+	}
 	for (std::vector<BattleUnit*>::const_iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
 	{
 		if (validTarget(*i, false, false))
@@ -1003,17 +1038,16 @@ int AIModule::getSpottingUnits(const Position& pos) const
 			if (dist > 20) continue;
 			Position originVoxel = _save->getTileEngine()->getSightOriginVoxel(*i);
 			originVoxel.z -= 2;
-			Position targetVoxel;
 			if (checking)
 			{
-				if (_save->getTileEngine()->canTargetUnit(&originVoxel, _save->getTile(pos), &targetVoxel, *i, _unit))
+				if (_save->getTileEngine()->canTargetUnitCached(&originVoxel, _save->getTile(pos), *i, _unit))
 				{
 					tally++;
 				}
 			}
 			else
 			{
-				if (_save->getTileEngine()->canTargetUnit(&originVoxel, _save->getTile(pos), &targetVoxel, *i))
+				if (_save->getTileEngine()->canTargetUnitCached(&originVoxel, _save->getTile(pos), *i))
 				{
 					tally++;
 				}
@@ -1148,7 +1182,8 @@ bool AIModule::selectPointNearTarget(BattleUnit *target, int maxTUs) const
 				if (x || y) // skip the unit itself
 				{
 					Position checkPath = target->getPosition() + Position (x, y, z);
-					if (_save->getTile(checkPath) == 0 || std::find(_reachable.begin(), _reachable.end(), _save->getTileIndex(checkPath))  == _reachable.end())
+					int checkIndex = _save->getTileIndex(checkPath);
+					if (_save->getTile(checkPath) == 0 || !_reachable.isReachable(checkIndex))
 						continue;
 					int dir = _save->getTileEngine()->getDirectionTo(checkPath, target->getPosition());
 					bool valid = _save->getTileEngine()->validMeleeRange(checkPath, dir, _unit, target, 0);
@@ -1156,17 +1191,16 @@ bool AIModule::selectPointNearTarget(BattleUnit *target, int maxTUs) const
 
 					if (valid && fitHere && !_save->getTile(checkPath)->getDangerous())
 					{
-						_save->getPathfinding()->calculate(_unit, checkPath, 0, maxTUs);
+						int steps = _reachable.getStepCount(checkIndex);
 
 						//for 100% dodge diff and on 4th difficulty it will allow aliens to move 10 squares around to made attack form behind.
-						int distanceCurrent = _save->getPathfinding()->getPath().size() - dodgeChanceDiff * _save->getTileEngine()->getArcDirection(dir - 4, dirTarget);
-						if (_save->getPathfinding()->getStartDirection() != -1 && distanceCurrent < distance)
+						int distanceCurrent = steps - dodgeChanceDiff * _save->getTileEngine()->getArcDirection(dir - 4, dirTarget);
+						if (steps > 0 && _reachable.getTUCost(checkIndex) <= maxTUs && distanceCurrent < distance)
 						{
 							_attackAction->target = checkPath;
 							returnValue = true;
 							distance = distanceCurrent;
 						}
-						_save->getPathfinding()->abortPath();
 					}
 				}
 			}
@@ -1433,7 +1467,6 @@ bool AIModule::findFirePoint()
 		return false;
 	std::vector<Position> randomTileSearch = _save->getTileSearch();
 	RNG::shuffle(randomTileSearch);
-	Position target;
 	const int BASE_SYSTEMATIC_SUCCESS = 100;
 	const int FAST_PASS_THRESHOLD = 125;
 	int bestScore = 0;
@@ -1442,8 +1475,8 @@ bool AIModule::findFirePoint()
 	{
 		Position pos = _unit->getPosition() + *i;
 		Tile *tile = _save->getTile(pos);
-		if (tile == 0  ||
-			std::find(_reachableWithAttack.begin(), _reachableWithAttack.end(), _save->getTileIndex(pos))  == _reachableWithAttack.end())
+		int tuCost = _reachableWithAttack.getTUCost(_save->getTileIndex(pos));
+		if (tile == 0  || tuCost == -1)
 			continue;
 		int score = 0;
 		// i should really make a function for this
@@ -1451,14 +1484,13 @@ bool AIModule::findFirePoint()
 			// 4 because -2 is eyes and 2 below that is the rifle (or at least that's my understanding)
 			Position(8,8, _unit->getHeight() + _unit->getFloatHeight() - tile->getTerrainLevel() - 4);
 
-		if (_save->getTileEngine()->canTargetUnit(&origin, _aggroTarget->getTile(), &target, _unit))
+		if (_save->getTileEngine()->canTargetUnitCached(&origin, _aggroTarget->getTile(), _unit))
 		{
-			_save->getPathfinding()->calculate(_unit, pos);
 			// can move here
-			if (_save->getPathfinding()->getStartDirection() != -1)
+			if (pos != _unit->getPosition())
 			{
 				score = BASE_SYSTEMATIC_SUCCESS - getSpottingUnits(pos) * 10;
-				score += _unit->getTimeUnits() - _save->getPathfinding()->getTotalTUCost();
+				score += _unit->getTimeUnits() - tuCost;
 				if (!_aggroTarget->checkViewSector(pos))
 				{
 					score += 10;
@@ -2165,7 +2197,7 @@ void AIModule::selectMeleeOrRanged()
 		{
 			_rifle = false;
 			_attackAction->weapon = melee;
-			_reachableWithAttack = _save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_HIT, _unit, melee));
+			_save->getPathfinding()->findReachable(_unit, BattleActionCost(BA_HIT, _unit, melee), _reachableWithAttack);
 			return;
 		}
 	}
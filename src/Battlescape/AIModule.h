@@ -20,6 +20,7 @@
 #include <yaml-cpp/yaml.h>
 #include "BattlescapeGame.h"
 #include "Position.h"
+#include "ReachableTiles.h"
 #include "../Savegame/BattleUnit.h"
 #include <vector>
 
@@ -50,7 +51,8 @@ private:
 	bool _traceAI, _didPsi;
 	int _AIMode, _intelligence, _closestDist;
 	Node *_fromNode, *_toNode;
-	std::vector<int> _reachable, _reachableWithAttack, _wasHitBy;
+	ReachableTiles _reachable, _reachableWithAttack;
+	std::vector<int> _wasHitBy;
 	BattleActionType _reserve;
 	UnitFaction _targetFaction;
 public:
@@ -68,6 +70,8 @@ public:
 	void setWasHitBy(BattleUnit *attacker);
 	/// Gets whether the unit was hit.
 	bool getWasHitBy(int attacker) const;
+	/// Sets the faction the unit goes after.
+	void setTargetFaction(UnitFaction faction);
 	/// setup a patrol objective.
 	void setupPatrol();
 	/// setup an ambush objective.
@@ -0,0 +1,479 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BattleBenchmark.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include "BattlescapeState.h"
+#include "BattlescapeGame.h"
+#include "BattlescapeGenerator.h"
+#include "AIModule.h"
+#include "../Engine/Game.h"
+#include "../Engine/Screen.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Timer.h"
+#include "../Engine/RNG.h"
+#include "../Mod/Mod.h"
+#include "../Mod/RuleItem.h"
+#include "../Mod/RuleCraft.h"
+#include "../Mod/RuleTerrain.h"
+#include "../Mod/RuleGlobe.h"
+#include "../Mod/AlienDeployment.h"
+#include "../Mod/RuleAlienMission.h"
+#include "../Savegame/SavedGame.h"
+#include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BattleUnit.h"
+#include "../Savegame/Base.h"
+#include "../Savegame/Craft.h"
+#include "../Savegame/Soldier.h"
+#include "../Savegame/ItemContainer.h"
+#include "../Savegame/Ufo.h"
+#include "../Savegame/MissionSite.h"
+#include "../Savegame/AlienBase.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Gets the time passed since a point.
+ * @param start Starting point.
+ * @return Seconds passed.
+ */
+double getSeconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+/**
+ * Sets up a benchmark.
+ * @param game Pointer to the core game.
+ */
+BattleBenchmark::BattleBenchmark(Game *game) : _game(game), _state(0), _steps(0)
+{
+}
+
+/**
+ *
+ */
+BattleBenchmark::~BattleBenchmark()
+{
+}
+
+/**
+ * Loads the mods, generates a mission and fights it for a number
+ * of turns, or until one side is gone, then reports the times taken.
+ * Everything random comes from the given seed, so the same mission,
+ * seed, mods and build always play out the same way.
+ * @param mission Mission type, as in the New Battle screen.
+ * @param terrain Terrain type, or empty for the first one that fits.
+ * @param seed Random seed, any number including 0.
+ * @param turns Number of turns.
+ * @return Program exit code.
+ */
+int BattleBenchmark::run(const std::string &mission, const std::string &terrain, int seed, int turns)
+{
+	try
+	{
+		Log(LOG_INFO) << "Loading data...";
+		Options::updateMods();
+		_game->loadMods();
+		_game->defaultLanguage();
+	}
+	catch (std::exception &e)
+	{
+		Log(LOG_ERROR) << e.what();
+		return EXIT_FAILURE;
+	}
+
+	Log(LOG_INFO) << "Generating " << mission << " with seed " << seed << "...";
+	// the generator gets stuck on a state of 0, and a sign-extended int
+	// can never equal this constant, so every seed gives a working state
+	RNG::setSeed((uint64_t)(int64_t)seed ^ 0x2545F4914F6CDD1DULL);
+	if (!generate(mission, terrain))
+	{
+		return EXIT_FAILURE;
+	}
+	SavedBattleGame *save = _game->getSavedGame()->getSavedBattle();
+	_mission = save->getMissionType();
+
+	Options::baseXResolution = Options::baseXBattlescape;
+	Options::baseYResolution = Options::baseYBattlescape;
+	_game->getScreen()->resetDisplay(false);
+	_state = new BattlescapeState;
+	_game->setState(_state);
+	save->setBattleState(_state);
+	_state->init();
+	_state->getBattleGame()->setAutoPlay(true);
+	closePopups();
+
+	Log(LOG_INFO) << "Fighting " << turns << " turns...";
+	Profiler::setEnabled(true);
+	Profiler::reset();
+	int number = save->getTurn();
+	Clock::time_point turnStart = Clock::now();
+	while (!isFinished())
+	{
+		UnitFaction side = save->getSide();
+		step();
+		_steps++;
+		if (isFinished())
+			break;
+
+		if (save->getSide() != side)
+		{
+			// the end of a side's turn, as the next turn screen would do it
+			_state->getBattleGame()->cleanupDeleted();
+			int liveAliens = 0, liveSoldiers = 0;
+			_state->getBattleGame()->tallyUnits(liveAliens, liveSoldiers);
+			if ((save->getObjectiveType() != MUST_DESTROY && liveAliens == 0) || liveSoldiers == 0)
+				break;
+		}
+		if (save->getTurn() != number)
+		{
+			endTurn(getSeconds(turnStart));
+			number = save->getTurn();
+			turnStart = Clock::now();
+			if ((int)_turns.size() >= turns)
+				break;
+		}
+		if (_steps > MAX_STEPS)
+		{
+			Log(LOG_WARNING) << "Turn " << number << " got stuck, stopping.";
+			break;
+		}
+	}
+	if (_steps > 0)
+	{
+		endTurn(getSeconds(turnStart));
+	}
+	Profiler::setEnabled(false);
+
+	report();
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Sets up a new battle the way the New Battle screen does it: a base
+ * with a full craft carrying one of every item, all research done and
+ * the first terrain and alien race that fit the mission.
+ * @param mission Mission type.
+ * @param terrain Terrain type, or empty for the first one that fits.
+ * @return True if the battle was generated.
+ */
+bool BattleBenchmark::generate(const std::string &mission, const std::string &terrain)
+{
+	const Mod *mod = _game->getMod();
+	AlienDeployment *ruleDeploy = mod->getDeployment(mission);
+	if (!ruleDeploy)
+	{
+		Log(LOG_ERROR) << "Unknown mission: " << mission;
+		return false;
+	}
+
+	std::string terrainType = terrain;
+	if (terrainType.empty())
+	{
+		std::set<std::string> terrains;
+		const std::vector<std::string> &deployTerrains = ruleDeploy->getTerrains();
+		std::vector<std::string> globeTerrains = mod->getGlobe()->getTerrains(deployTerrains.empty() ? "" : ruleDeploy->getType());
+		terrains.insert(deployTerrains.begin(), deployTerrains.end());
+		terrains.insert(globeTerrains.begin(), globeTerrains.end());
+		if (!terrains.empty())
+		{
+			terrainType = *terrains.begin();
+		}
+	}
+	RuleTerrain *ruleTerrain = mod->getTerrain(terrainType);
+	if (!ruleTerrain)
+	{
+		Log(LOG_ERROR) << "Unknown terrain: " << terrainType;
+		return false;
+	}
+
+	const RuleCraft *ruleCraft = 0;
+	for (std::vector<std::string>::const_iterator i = mod->getCraftsList().begin(); i != mod->getCraftsList().end() && !ruleCraft; ++i)
+	{
+		if (mod->getCraft(*i)->getSoldiers() > 0)
+		{
+			ruleCraft = mod->getCraft(*i);
+		}
+	}
+	std::string race;
+	for (std::vector<std::string>::const_iterator i = mod->getAlienRacesList().begin(); i != mod->getAlienRacesList().end() && race.empty(); ++i)
+	{
+		if ((*i).find("_UNDERWATER") == std::string::npos)
+		{
+			race = *i;
+		}
+	}
+	if (!ruleCraft || race.empty() || mod->getSoldiersList().empty())
+	{
+		Log(LOG_ERROR) << "The mods have no craft, soldiers or alien races to fight with.";
+		return false;
+	}
+
+	SavedGame *save = new SavedGame();
+	_game->setSavedGame(save);
+	Base *base = new Base(mod);
+	base->load(mod->getStartingBase(), save, true, true);
+	save->getBases()->push_back(base);
+
+	// Kill everything we don't want in this base
+	for (std::vector<Soldier*>::iterator i = base->getSoldiers()->begin(); i != base->getSoldiers()->end(); ++i) delete (*i);
+	base->getSoldiers()->clear();
+	for (std::vector<Craft*>::iterator i = base->getCrafts()->begin(); i != base->getCrafts()->end(); ++i) delete (*i);
+	base->getCrafts()->clear();
+	base->getStorageItems()->getContents()->clear();
+
+	Craft *craft = new Craft(ruleCraft, base, 1);
+	base->getCrafts()->push_back(craft);
+	for (int i = 0; i < ruleCraft->getSoldiers(); ++i)
+	{
+		int randomType = RNG::generate(0, mod->getSoldiersList().size() - 1);
+		Soldier *soldier = mod->genSoldier(save, mod->getSoldiersList().at(randomType));
+		base->getSoldiers()->push_back(soldier);
+		soldier->setCraft(craft);
+	}
+	const std::vector<std::string> &items = mod->getItemsList();
+	for (std::vector<std::string>::const_iterator i = items.begin(); i != items.end(); ++i)
+	{
+		RuleItem *rule = mod->getItem(*i);
+		if (rule->getBattleType() != BT_CORPSE && rule->isRecoverable())
+		{
+			base->getStorageItems()->addItem(*i, 1);
+			if (rule->getBattleType() != BT_NONE && !rule->isFixed() && rule->getBigSprite() > -1)
+			{
+				craft->getItems()->addItem(*i, 1);
+			}
+		}
+	}
+	for (auto& pair : mod->getResearchMap())
+	{
+		save->addFinishedResearchSimple(pair.second);
+	}
+
+	SavedBattleGame *bgame = new SavedBattleGame(_game->getMod());
+	save->setBattleGame(bgame);
+	bgame->setMissionType(mission);
+	BattlescapeGenerator bgen = BattlescapeGenerator(_game);
+	bgen.setTerrain(ruleTerrain);
+
+	if (mission == "STR_BASE_DEFENSE")
+	{
+		bgen.setBase(base);
+		craft = 0;
+	}
+	else if (ruleDeploy->isAlienBase())
+	{
+		AlienBase *b = new AlienBase(ruleDeploy);
+		b->setId(1);
+		b->setAlienRace(race);
+		craft->setDestination(b);
+		bgen.setAlienBase(b);
+		save->getAlienBases()->push_back(b);
+	}
+	else if (mod->getUfo(mission))
+	{
+		Ufo *u = new Ufo(mod->getUfo(mission));
+		u->setId(1);
+		craft->setDestination(u);
+		bgen.setUfo(u);
+		if (RNG::generate(0, 1) == 1)
+		{
+			u->setStatus(Ufo::LANDED);
+			bgame->setMissionType("STR_UFO_GROUND_ASSAULT");
+		}
+		else
+		{
+			u->setStatus(Ufo::CRASHED);
+			bgame->setMissionType("STR_UFO_CRASH_RECOVERY");
+		}
+		save->getUfos()->push_back(u);
+	}
+	else
+	{
+		const RuleAlienMission *alienMission = mod->getAlienMission(mod->getAlienMissionList().front()); // doesn't matter
+		MissionSite *m = new MissionSite(alienMission, ruleDeploy, nullptr);
+		m->setId(1);
+		m->setAlienRace(race);
+		craft->setDestination(m);
+		bgen.setMissionSite(m);
+		save->getMissionSites()->push_back(m);
+	}
+	if (craft)
+	{
+		craft->setSpeed(0);
+		bgen.setCraft(craft);
+	}
+
+	save->setDifficulty(DIFF_BEGINNER);
+	bgen.setWorldShade(0);
+	bgen.setAlienRace(race);
+	bgen.setAlienItemlevel(0);
+	bool underwater = ruleDeploy->getMaxDepth() > 0 || ruleTerrain->getMaxDepth() > 0;
+	bgame->setDepth(underwater ? 1 : 0);
+	bgen.run();
+	return true;
+}
+
+/**
+ * Runs one step of the battle, as the Battlescape timer would,
+ * with the player's soldiers moved by the AI.
+ */
+void BattleBenchmark::step()
+{
+	BattlescapeGame *battle = _state->getBattleGame();
+	BattleUnit *unit = battle->getSave()->getSelectedUnit();
+	if (unit && !battle->isBusy())
+	{
+		prepareAI(unit);
+	}
+	battle->think();
+	battle->handleState();
+	if (!isFinished())
+	{
+		closePopups();
+	}
+}
+
+/**
+ * Points the AI of a unit at the right side: the player's units
+ * go after the aliens, and soldiers under alien control go back
+ * to going after the player.
+ * @param unit Pointer to the unit.
+ */
+void BattleBenchmark::prepareAI(BattleUnit *unit)
+{
+	SavedBattleGame *save = _state->getBattleGame()->getSave();
+	if (unit->getFaction() == FACTION_PLAYER)
+	{
+		if (!unit->getAIModule())
+		{
+			unit->setAIModule(new AIModule(save, unit, 0));
+		}
+		unit->getAIModule()->setTargetFaction(FACTION_HOSTILE);
+	}
+	else if (unit->getOriginalFaction() == FACTION_PLAYER && unit->getAIModule())
+	{
+		unit->getAIModule()->setTargetFaction(FACTION_PLAYER);
+	}
+}
+
+/**
+ * Closes every popup the battle opened, as if the player
+ * had clicked them away, and gets the battle going again.
+ */
+void BattleBenchmark::closePopups()
+{
+	if (!_state->clearPopups() && _game->isState(_state))
+		return;
+
+	while (!_game->isState(_state))
+	{
+		_game->popState();
+	}
+	_state->getBattleGame()->init();
+}
+
+/**
+ * Adds the times taken by the turn that just ended.
+ * @param time Seconds the turn took.
+ */
+void BattleBenchmark::endTurn(double time)
+{
+	Turn turn;
+	turn.time = time;
+	for (int i = 0; i < Profiler::PROFILE_BATTLE_COUNT; ++i)
+	{
+		turn.sections[i] = Profiler::getTime((Profiler::Section)i);
+	}
+	_turns.push_back(turn);
+	Profiler::reset();
+	_steps = 0;
+}
+
+/**
+ * Checks if the battle is over: it got finished, either
+ * for good or to go on to the next stage of the mission.
+ * @return True if it's over.
+ */
+bool BattleBenchmark::isFinished() const
+{
+	return !_state->isRunning() || _state->getBattleGame()->getSave()->getMissionType() != _mission;
+}
+
+/**
+ * Writes the time taken per turn and per section of the battle logic.
+ */
+void BattleBenchmark::report() const
+{
+	double total = 0.0;
+	double sections[Profiler::PROFILE_BATTLE_COUNT] = {};
+	for (std::vector<Turn>::const_iterator i = _turns.begin(); i != _turns.end(); ++i)
+	{
+		total += i->time;
+		for (int j = 0; j < Profiler::PROFILE_BATTLE_COUNT; ++j)
+		{
+			sections[j] += i->sections[j];
+		}
+	}
+	int liveAliens = 0, liveSoldiers = 0;
+	_state->getBattleGame()->tallyUnits(liveAliens, liveSoldiers);
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "Fought " << _turns.size() << " turns of " << _mission << " in " << total << " s" << std::endl;
+	ss << "Aliens left: " << liveAliens << ", soldiers left: " << liveSoldiers << std::endl;
+	ss << std::endl;
+	ss << std::setw(6) << "Turn" << std::setw(12) << "Total ms";
+	for (int j = 0; j < Profiler::PROFILE_BATTLE_COUNT; ++j)
+	{
+		ss << std::setw(15) << Profiler::getName((Profiler::Section)j);
+	}
+	ss << std::endl;
+	for (size_t i = 0; i < _turns.size(); ++i)
+	{
+		ss << std::setw(6) << i + 1 << std::setw(12) << _turns[i].time * 1000;
+		for (int j = 0; j < Profiler::PROFILE_BATTLE_COUNT; ++j)
+		{
+			ss << std::setw(15) << _turns[i].sections[j] * 1000;
+		}
+		ss << std::endl;
+	}
+	ss << std::setw(6) << "All" << std::setw(12) << total * 1000;
+	for (int j = 0; j < Profiler::PROFILE_BATTLE_COUNT; ++j)
+	{
+		ss << std::setw(15) << sections[j] * 1000;
+	}
+	ss << std::endl;
+	std::cout << ss.str();
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+#include "../Engine/Profiler.h"
+
+namespace OpenXcom
+{
+
+class Game;
+class BattlescapeState;
+class BattleUnit;
+
+/**
+ * Fights a battle without a window or a player, to measure how
+ * fast the tactical game logic goes for a given mission and set
+ * of mods. The soldiers are played by the same AI as the aliens,
+ * the map isn't drawn or animated and popups are closed as soon
+ * as they come up, then the time taken by each turn and by the
+ * main parts of the battle logic gets reported.
+ */
+class BattleBenchmark
+{
+private:
+	struct Turn
+	{
+		double time;
+		double sections[Profiler::PROFILE_BATTLE_COUNT];
+	};
+	static const int MAX_STEPS = 200000;
+
+	Game *_game;
+	BattlescapeState *_state;
+	std::string _mission;
+	std::vector<Turn> _turns;
+	int _steps;
+
+	/// Sets up the battle.
+	bool generate(const std::string &mission, const std::string &terrain);
+	/// Runs one step of the battle.
+	void step();
+	/// Hands a unit to the AI.
+	void prepareAI(BattleUnit *unit);
+	/// Closes any popups.
+	void closePopups();
+	/// Adds up a turn.
+	void endTurn(double time);
+	/// Checks if the battle is over.
+	bool isFinished() const;
+	/// Reports the results.
+	void report() const;
+public:
+	/// Creates a benchmark for a game.
+	BattleBenchmark(Game *game);
+	/// Cleans up the benchmark.
+	~BattleBenchmark();
+	/// Fights a mission for a number of turns.
+	int run(const std::string &mission, const std::string &terrain, int seed, int turns);
+};
+
+}
@@ -57,6 +57,7 @@
 #include "../Engine/Logger.h"
 #include "../Savegame/BattleUnitStatistics.h"
 #include "../fmath.h"
+#include "../Engine/ThreadPool.h"
 
 namespace OpenXcom
 {
@@ -193,8 +194,14 @@ BattleActionAttack::BattleActionAttack(const BattleActionCost& action, BattleIte
  * @param save Pointer to the save game.
  * @param parentState Pointer to the parent battlescape state.
  */
-BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parentState) : _save(save), _parentState(parentState), _playerPanicHandled(true), _AIActionCounter(0), _AISecondMove(false), _playedAggroSound(false), _endTurnRequested(false), _endTurnProcessed(false)
+BattlescapeGame::BattlescapeGame(SavedBattleGame *save, BattlescapeState *parentState) : _save(save), _parentState(parentState), _playerPanicHandled(true), _AIActionCounter(0), _AISecondMove(false), _playedAggroSound(false), _endTurnRequested(false), _endTurnProcessed(false), _autoPlay(false),
+	_aiThread(0), _aiPathfinding(0), _speculativeUnit(0), _readyUnit(0), _speculativeState(0), _readyState(0)
 {
+	if (Options::speculativeAI)
+	{
+		_aiThread = new ThreadPool(1);
+		_aiPathfinding = new Pathfinding(_save);
+	}
 
 	_currentAction.actor = 0;
 	_currentAction.targeting = false;
@@ -217,6 +224,8 @@ BattlescapeGame::~BattlescapeGame()
 		delete *i;
 	}
 	cleanupDeleted();
+	delete _aiThread;
+	delete _aiPathfinding;
 }
 
 /**
@@ -233,16 +242,22 @@ void BattlescapeGame::think()
 			_save->setUnitsFalling(false);
 			return;
 		}
-		// it's a non player side (ALIENS or CIVILIANS)
-		if (_save->getSide() != FACTION_PLAYER)
+		// it's a non player side (ALIENS or CIVILIANS), or the player's side played by the AI once its panicking units are handled
+		if (_save->getSide() != FACTION_PLAYER || (_autoPlay && _playerPanicHandled))
 		{
 			_save->resetUnitHitStates();
 			if (!_debugPlay)
 			{
-				if (_save->getSelectedUnit())
+				BattleUnit *unit = _save->getSelectedUnit();
+				if (unit && _save->getSide() == FACTION_PLAYER && (unit->getFaction() != FACTION_PLAYER || unit->isOut()))
+				{
+					// the AI can't move a soldier that got knocked out or mind controlled while selected
+					unit = 0;
+				}
+				if (unit)
 				{
-					if (!handlePanickingUnit(_save->getSelectedUnit()))
-						handleAI(_save->getSelectedUnit());
+					if (!handlePanickingUnit(unit))
+						handleAI(unit);
 				}
 				else
 				{
@@ -351,6 +366,7 @@ void BattlescapeGame::handleAI(BattleUnit *unit)
 	BattleAction action;
 	action.actor = unit;
 	action.number = _AIActionCounter;
+	startSpeculativeAI(unit);
 	unit->think(&action);
 
 	if (action.type == BA_RETHINK)
@@ -358,6 +374,10 @@ void BattlescapeGame::handleAI(BattleUnit *unit)
 		_parentState->debug(L"Rethink");
 		unit->think(&action);
 	}
+	if (_aiThread)
+	{
+		_aiThread->wait(); // the world may change from here on
+	}
 
 	_AIActionCounter = action.number;
 	BattleItem *weapon = unit->getMainHandWeapon();
@@ -444,6 +464,91 @@ void BattlescapeGame::handleAI(BattleUnit *unit)
 	}
 }
 
+/**
+ * Gets everything the reachable tiles of an AI unit depend on:
+ * the battle state and the unit's own time units, energy and
+ * the enemies it knows about.
+ * @param unit Pointer to the AI unit.
+ * @return Checksum of the state.
+ */
+Uint64 BattlescapeGame::getSpeculativeState(BattleUnit *unit) const
+{
+	Uint64 state = _save->getTileEngine()->getBattleStateChecksum();
+	int values[3] = { unit->getTimeUnits(), unit->getEnergy(), (int)unit->getUnitsSpottedThisTurn().size() };
+	for (int n = 0; n < 3; ++n)
+	{
+		state = (state ^ (Uint32)values[n]) * 1099511628211ULL;
+	}
+	return state;
+}
+
+/**
+ * Guesses which AI unit moves after this one and finds the tiles
+ * it can reach on the worker thread, while this unit thinks.
+ * Thinking doesn't change the battle, so both only read it; the
+ * result of the previous guess is kept for this unit to pick up.
+ * @param unit Pointer to the AI unit about to think.
+ */
+void BattlescapeGame::startSpeculativeAI(BattleUnit *unit)
+{
+	if (!_aiThread)
+	{
+		return;
+	}
+	_aiThread->wait();
+	_readyUnit = _speculativeUnit;
+	_readyState = _speculativeState;
+	std::swap(_readyReach, _speculativeReach);
+	_speculativeUnit = 0;
+
+	std::vector<BattleUnit*>::iterator i = std::find(_save->getUnits()->begin(), _save->getUnits()->end(), unit);
+	if (i == _save->getUnits()->end())
+	{
+		return;
+	}
+	for (++i; i != _save->getUnits()->end(); ++i)
+	{
+		if ((*i)->isSelectable(_save->getSide(), true, false))
+		{
+			_speculativeUnit = *i;
+			_speculativeState = getSpeculativeState(*i);
+			_aiThread->start(speculativeAIJob, this, 1);
+			return;
+		}
+	}
+}
+
+/**
+ * Finds the tiles the guessed next AI unit can reach, using
+ * pathfinding of its own. Runs on the worker thread.
+ * @param data Pointer to the BattlescapeGame.
+ * @param part Unused.
+ */
+void BattlescapeGame::speculativeAIJob(void *data, int)
+{
+	BattlescapeGame *self = (BattlescapeGame*)data;
+	self->_aiPathfinding->findReachable(self->_speculativeUnit, BattleActionCost(), self->_speculativeReach);
+}
+
+/**
+ * Hands the reachable tiles found ahead of time to an AI unit,
+ * if they were found for this unit and nothing they depend on
+ * changed since.
+ * @param unit Pointer to the AI unit.
+ * @param reach Receives the reachable tiles.
+ * @return True if the tiles were found ahead of time.
+ */
+bool BattlescapeGame::getSpeculativeReach(BattleUnit *unit, ReachableTiles &reach)
+{
+	if (unit != _readyUnit || getSpeculativeState(unit) != _readyState)
+	{
+		return false;
+	}
+	std::swap(reach, _readyReach);
+	_readyUnit = 0;
+	return true;
+}
+
 /**
  * Toggles the Kneel/Standup status of the unit.
  * @param bu Pointer to a unit.
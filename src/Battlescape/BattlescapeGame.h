@@ -18,6 +18,7 @@
  * along with OpenXcom.  If not, see <http:///www.gnu.org/licenses/>.
  */
 #include "Position.h"
+#include "ReachableTiles.h"
 #include "../Mod/RuleItem.h"
 #include <SDL.h>
 #include <string>
@@ -38,6 +39,7 @@ class Pathfinding;
 class Mod;
 class InfoboxOKState;
 class SoldierDiary;
+class ThreadPool;
 
 enum BattleActionType : Uint8 { BA_NONE, BA_TURN, BA_WALK, BA_KNEEL, BA_PRIME, BA_UNPRIME, BA_THROW, BA_AUTOSHOT, BA_SNAPSHOT, BA_AIMEDSHOT, BA_HIT, BA_USE, BA_LAUNCH, BA_MINDCONTROL, BA_PANIC, BA_RETHINK };
 enum BattleActionMove { BAM_NORMAL = 0, BAM_RUN = 1, BAM_STRAFE = 2 };
@@ -121,6 +123,12 @@ private:
 	BattleAction _currentAction;
 	bool _AISecondMove, _playedAggroSound;
 	bool _endTurnRequested, _endTurnProcessed;
+	bool _autoPlay;
+	ThreadPool *_aiThread;
+	Pathfinding *_aiPathfinding;
+	BattleUnit *_speculativeUnit, *_readyUnit;
+	ReachableTiles _speculativeReach, _readyReach;
+	Uint64 _speculativeState, _readyState;
 
 	/// Ends the turn.
 	void endTurn();
@@ -133,6 +141,12 @@ private:
 	std::vector<InfoboxOKState*> _infoboxQueue;
 	/// Shows the infoboxes in the queue (if any).
 	void showInfoBoxQueue();
+	/// Gets the state a speculative AI result depends on.
+	Uint64 getSpeculativeState(BattleUnit *unit) const;
+	/// Starts looking ahead for the AI unit after this one.
+	void startSpeculativeAI(BattleUnit *unit);
+	/// Finds the tiles the speculative AI unit can reach.
+	static void speculativeAIJob(void *data, int part);
 public:
 	/// is debug mode enabled in the battlescape?
 	static bool _debugPlay;
@@ -167,6 +181,8 @@ public:
 	bool checkReservedTU(BattleUnit *bu, int tu, int energy, bool justChecking = false);
 	/// Handles unit AI.
 	void handleAI(BattleUnit *unit);
+	/// Gets the reachable tiles found ahead of time for an AI unit.
+	bool getSpeculativeReach(BattleUnit *unit, ReachableTiles &reach);
 	/// Drops an item and affects it with gravity.
 	void dropItem(Position position, BattleItem *item, bool removeItem = false, bool updateLight = true);
 	/// Converts a unit into a unit of another type.
@@ -209,6 +225,8 @@ public:
 	Mod *getMod();
 	/// Returns whether panic has been handled.
 	bool getPanicHandled() const { return _playerPanicHandled; }
+	/// Lets the AI move the player's units too.
+	void setAutoPlay(bool autoPlay) { _autoPlay = autoPlay; }
 	/// Tries to find an item and pick it up if possible.
 	void findItem(BattleAction *action);
 	/// Checks through all the items on the ground and picks one.
@@ -530,6 +530,8 @@ void BattlescapeState::init()
 	_animTimer->start();
 	_gameTimer->start();
 	_map->setFocus(true);
+	// anything could have changed while other states were on top
+	_map->invalidate();
 	_map->draw();
 	_battleGame->init();
 	updateSoldierInfo();
@@ -1573,6 +1575,12 @@ inline void BattlescapeState::handle(Action *action)
 		{
 			State::handle(action);
 
+			// clicks and keys can change anything on the map (selection, path preview, ...), plain mouse moves only the cursor
+			if (action->getDetails()->type != SDL_MOUSEMOTION)
+			{
+				_map->invalidate();
+			}
+
 			if (Options::touchEnabled == false && _isMouseScrolling && !Options::battleDragScrollInvert)
 			{
 				_map->setSelectorPosition((_cursorPosition.x - _game->getScreen()->getCursorLeftBlackBand()) / action->getXScale(), (_cursorPosition.y - _game->getScreen()->getCursorTopBlackBand()) / action->getYScale());
@@ -2015,6 +2023,33 @@ void BattlescapeState::popup(State *state)
 	_popups.push_back(state);
 }
 
+/**
+ * Drops the popups waiting in the queue without showing them.
+ * @return True if there were any.
+ */
+bool BattlescapeState::clearPopups()
+{
+	if (_popups.empty())
+		return false;
+
+	for (std::vector<State*>::iterator i = _popups.begin(); i != _popups.end(); ++i)
+	{
+		delete *i;
+	}
+	_popups.clear();
+	return true;
+}
+
+/**
+ * Checks if the battle is still going on,
+ * or if it was finished and is waiting for the debriefing.
+ * @return True if it's still going on.
+ */
+bool BattlescapeState::isRunning() const
+{
+	return _gameTimer->isRunning();
+}
+
 /**
  * Finishes up the current battle, shuts down the battlescape
  * and presents the debriefing screen for the mission.
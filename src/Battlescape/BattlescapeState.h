@@ -224,6 +224,10 @@ public:
 	void stopScrolling(Action *action);
 	/// Autosave next turn.
 	void autosave();
+	/// Drops the popups waiting in the queue.
+	bool clearPopups();
+	/// Checks if the battle is still going on.
+	bool isRunning() const;
 };
 
 }
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "InfluenceMap.h"
+#include <algorithm>
+#include "../Savegame/SavedBattleGame.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Sets up an influence map without any units on it.
+ * @param save Pointer to the battlescape.
+ * @param range Distance in tiles a unit threatens.
+ */
+InfluenceMap::InfluenceMap(SavedBattleGame *save, int range) : _save(save), _range(range)
+{
+	for (int i = 0; i <= FACTION_NEUTRAL; ++i)
+	{
+		_threat[i].resize(_save->getMapSizeX() * _save->getMapSizeY(), 0);
+	}
+	_cover.resize(_save->getMapSizeXYZ(), 0);
+	_danger.resize(_save->getMapSizeX() * _save->getMapSizeY(), 0);
+}
+
+/**
+ * Deletes the influence map.
+ */
+InfluenceMap::~InfluenceMap()
+{
+
+}
+
+/**
+ * Adds the threat of a unit to every column within range of it,
+ * using the same distance as TileEngine::distance(), or removes it.
+ * @param source The unit's influence.
+ * @param sign 1 to add, -1 to remove.
+ */
+void InfluenceMap::applyThreat(const Source &source, int sign)
+{
+	if (!source.active)
+	{
+		return;
+	}
+	std::vector<Uint16> &threat = _threat[source.faction];
+	int width = _save->getMapSizeX();
+	int minY = std::max(0, source.pos.y - _range), maxY = std::min(_save->getMapSizeY() - 1, source.pos.y + _range);
+	int minX = std::max(0, source.pos.x - _range), maxX = std::min(width - 1, source.pos.x + _range);
+	for (int y = minY; y <= maxY; ++y)
+	{
+		int dy = y - source.pos.y;
+		for (int x = minX; x <= maxX; ++x)
+		{
+			int dx = x - source.pos.x;
+			if (dx * dx + dy * dy <= _range * _range)
+			{
+				threat[y * width + x] += sign;
+			}
+		}
+	}
+}
+
+/**
+ * Compares every unit with its influence at the last update and
+ * moves the influence of the ones that changed.
+ */
+void InfluenceMap::update()
+{
+	std::vector<BattleUnit*> *units = _save->getUnits();
+	for (size_t i = 0; i < units->size(); ++i)
+	{
+		BattleUnit *unit = units->at(i);
+		Source now = { unit, unit->getPosition(), unit->getFaction(), !unit->isOut() };
+		if (i == _sources.size())
+		{
+			Source none = { unit, now.pos, now.faction, false };
+			_sources.push_back(none);
+		}
+		Source &before = _sources[i];
+		if (before.unit != now.unit || before.pos != now.pos || before.faction != now.faction || before.active != now.active)
+		{
+			applyThreat(before, -1);
+			applyThreat(now, 1);
+			before = now;
+		}
+	}
+	while (_sources.size() > units->size())
+	{
+		applyThreat(_sources.back(), -1);
+		_sources.pop_back();
+	}
+}
+
+/**
+ * Gets how many active units of a faction are within range of a position.
+ * None of them could see the position if this is zero.
+ * @param faction Faction of the units.
+ * @param pos Position on the map.
+ * @return Number of units.
+ */
+int InfluenceMap::getThreat(UnitFaction faction, Position pos) const
+{
+	if (pos.x < 0 || pos.y < 0 || pos.x >= _save->getMapSizeX() || pos.y >= _save->getMapSizeY())
+	{
+		return 0;
+	}
+	return _threat[faction][pos.y * _save->getMapSizeX() + pos.x];
+}
+
+/**
+ * Sets how many of the eight sides of a tile block sight.
+ * @param pos Position on the map.
+ * @param cover Number of sides.
+ */
+void InfluenceMap::setCover(Position pos, int cover)
+{
+	_cover[_save->getTileIndex(pos)] = cover;
+}
+
+/**
+ * Gets how many of the eight sides of a tile block sight,
+ * the more the harder it is to be seen or shot there.
+ * @param pos Position on the map.
+ * @return Number of sides.
+ */
+int InfluenceMap::getCover(Position pos) const
+{
+	if (!_save->getTile(pos))
+	{
+		return 0;
+	}
+	return _cover[_save->getTileIndex(pos)];
+}
+
+/**
+ * Adds a blast the AI knows about to every column within its radius.
+ * @param pos Centre of the blast.
+ * @param radius Radius of the blast in tiles.
+ */
+void InfluenceMap::addDanger(Position pos, int radius)
+{
+	int width = _save->getMapSizeX();
+	int minY = std::max(0, pos.y - radius), maxY = std::min(_save->getMapSizeY() - 1, pos.y + radius);
+	int minX = std::max(0, pos.x - radius), maxX = std::min(width - 1, pos.x + radius);
+	for (int y = minY; y <= maxY; ++y)
+	{
+		int dy = y - pos.y;
+		for (int x = minX; x <= maxX; ++x)
+		{
+			int dx = x - pos.x;
+			if (dx * dx + dy * dy <= radius * radius)
+			{
+				++_danger[y * width + x];
+			}
+		}
+	}
+}
+
+/**
+ * Drops all known blasts, they only last for a turn.
+ */
+void InfluenceMap::clearDanger()
+{
+	std::fill(_danger.begin(), _danger.end(), 0);
+}
+
+/**
+ * Gets how many known blasts of this turn can reach a position.
+ * Unlike Tile::getDangerous() it also counts positions behind cover,
+ * so the AI keeps some distance from a blast.
+ * @param pos Position on the map.
+ * @return Number of blasts.
+ */
+int InfluenceMap::getDanger(Position pos) const
+{
+	if (pos.x < 0 || pos.y < 0 || pos.x >= _save->getMapSizeX() || pos.y >= _save->getMapSizeY())
+	{
+		return 0;
+	}
+	return _danger[pos.y * _save->getMapSizeX() + pos.x];
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "Position.h"
+#include "../Savegame/BattleUnit.h"
+
+namespace OpenXcom
+{
+
+class SavedBattleGame;
+
+/**
+ * Layers of the battlescape the AI scores tiles with:
+ * - threat: for every map column, how many active units of each faction
+ *   are close enough to look at it. It is kept up to date by only moving
+ *   the influence of units that moved, fell or got up since the last update.
+ * - cover: for every tile, how many of its sides block sight, updated by
+ *   TileEngine with the terrain around a change.
+ * - danger: for every map column, how many known blasts this turn can reach it.
+ */
+class InfluenceMap
+{
+private:
+	/**
+	 * Influence a unit had at the last update.
+	 */
+	struct Source
+	{
+		BattleUnit *unit;
+		Position pos;
+		UnitFaction faction;
+		bool active;
+	};
+	SavedBattleGame *_save;
+	int _range;
+	std::vector<Uint16> _threat[FACTION_NEUTRAL + 1];
+	std::vector<Source> _sources;
+	std::vector<Uint8> _cover;
+	std::vector<Uint16> _danger;
+
+	/// Adds or removes the threat of a unit.
+	void applyThreat(const Source &source, int sign);
+public:
+	/// Creates an empty influence map for the battlescape.
+	InfluenceMap(SavedBattleGame *save, int range);
+	/// Cleans up the influence map.
+	~InfluenceMap();
+	/// Catches up with units that changed since the last update.
+	void update();
+	/// Gets how many units of a faction can look at a position.
+	int getThreat(UnitFaction faction, Position pos) const;
+	/// Sets how many sides of a tile block sight.
+	void setCover(Position pos, int cover);
+	/// Gets how many sides of a tile block sight.
+	int getCover(Position pos) const;
+	/// Adds a blast the AI knows about.
+	void addDanger(Position pos, int radius);
+	/// Drops the known blasts of the last turn.
+	void clearDanger();
+	/// Gets how many known blasts can reach a position.
+	int getDanger(Position pos) const;
+};
+
+}
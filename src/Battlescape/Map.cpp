@@ -31,6 +31,7 @@
 #include "../Engine/Action.h"
 #include "../Engine/SurfaceSet.h"
 #include "../Engine/Timer.h"
+#include "../Engine/ThreadPool.h"
 #include "../Engine/Language.h"
 #include "../Engine/Palette.h"
 #include "../Engine/Game.h"
@@ -76,7 +77,7 @@ namespace OpenXcom
  * @param y Y position in pixels.
  * @param visibleMapHeight Current visible map height.
  */
-Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false)
+Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight) : InteractiveSurface(width, height, x, y), _game(game), _arrow(0), _selectorX(0), _selectorY(0), _mouseX(0), _mouseY(0), _cursorType(CT_NORMAL), _cursorSize(1), _animFrame(0), _projectile(0), _projectileInFOV(false), _explosionInFOV(false), _launch(false), _visibleMapHeight(visibleMapHeight), _unitDying(false), _smoothingEngaged(false), _flashScreen(false), _drawnAllLayers(false), _drawnTerrain(false), _drawnSelectedUnit(0)
 {
 	_iconHeight = _game->getMod()->getInterface("battlescape")->getElement("icons")->h;
 	_iconWidth = _game->getMod()->getInterface("battlescape")->getElement("icons")->w;
@@ -113,6 +114,10 @@ Map::Map(Game *game, int width, int height, int x, int y, int visibleMapHeight)
 	_txtAccuracy->setPalette(_game->getScreen()->getPalette());
 	_txtAccuracy->setHighContrast(true);
 	_txtAccuracy->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
+	_txtAccuracyLock = SDL_CreateMutex();
+
+	// the screen scales on the same threads after the map is drawn
+	_threadPool = _game->getScreen()->getThreadPool();
 }
 
 /**
@@ -126,6 +131,11 @@ Map::~Map()
 	delete _message;
 	delete _camera;
 	delete _txtAccuracy;
+	SDL_DestroyMutex(_txtAccuracyLock);
+	for (std::vector<Surface*>::iterator i = _terrainCache.begin(); i != _terrainCache.end(); ++i)
+	{
+		delete *i;
+	}
 }
 
 /**
@@ -215,14 +225,487 @@ void Map::draw()
 		}
 	}
 
-	if ((_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSelectedUnit() == 0 || _save->getDebugMode() || _projectileInFOV || _explosionInFOV)
+	_dirtyAreas.clear();
+	_drawnTerrain = canDrawTerrain() || _projectileInFOV || _explosionInFOV;
+	if (_drawnTerrain)
 	{
-		drawTerrain(this);
+		drawTerrain(this, Position(0, 0, 0));
 	}
 	else
 	{
 		_message->blit(this);
 	}
+	// remember what the retained image shows, the dirty areas can only be drawn on top of it if nothing here changed
+	_drawnMapOffset = _camera->getMapOffset();
+	_drawnAllLayers = _camera->getShowAllLayers();
+	_drawnSelectedUnit = _save->getSelectedUnit();
+}
+
+/**
+ * Checks if the terrain is shown, or hidden by the hidden movement screen.
+ * @return True if the terrain is shown.
+ */
+bool Map::canDrawTerrain() const
+{
+	return (_save->getSelectedUnit() && _save->getSelectedUnit()->getVisible()) || _unitDying || _save->getSelectedUnit() == 0 || _save->getDebugMode();
+}
+
+/**
+ * Checks if the image drawn last time can be updated by redrawing only the dirty areas.
+ * Anything that moves the whole view or hides it needs a full redraw.
+ * @return True if the dirty areas are enough.
+ */
+bool Map::canDrawDirtyAreas() const
+{
+	return _camera->getMapOffset() == _drawnMapOffset
+		&& _camera->getShowAllLayers() == _drawnAllLayers
+		&& _save->getSelectedUnit() == _drawnSelectedUnit
+		&& canDrawTerrain() == _drawnTerrain;
+}
+
+/**
+ * Redraws only the dirty areas of the map on top of the image drawn before.
+ * Every area is drawn through a surface sharing the map pixels, so all
+ * tiles overlapping it are drawn again in the usual order but can't
+ * change anything outside of it.
+ */
+void Map::drawDirtyAreas()
+{
+	// merge overlapping areas, neighbouring tiles are usually dirty together;
+	// a grown area can overlap ones already checked, so repeat until nothing merges
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < _dirtyAreas.size(); ++i)
+		{
+			for (size_t j = i + 1; j < _dirtyAreas.size();)
+			{
+				GraphSubset common = GraphSubset::intersection(_dirtyAreas[i], _dirtyAreas[j]);
+				if (common.size_x() > 0 && common.size_y() > 0)
+				{
+					_dirtyAreas[i].beg_x = std::min(_dirtyAreas[i].beg_x, _dirtyAreas[j].beg_x);
+					_dirtyAreas[i].end_x = std::max(_dirtyAreas[i].end_x, _dirtyAreas[j].end_x);
+					_dirtyAreas[i].beg_y = std::min(_dirtyAreas[i].beg_y, _dirtyAreas[j].beg_y);
+					_dirtyAreas[i].end_y = std::max(_dirtyAreas[i].end_y, _dirtyAreas[j].end_y);
+					_dirtyAreas.erase(_dirtyAreas.begin() + j);
+					merged = true;
+				}
+				else
+				{
+					++j;
+				}
+			}
+		}
+	}
+
+	if (_drawnTerrain)
+	{
+		const GraphSubset screen = GraphSubset(getWidth(), getHeight());
+		std::vector<GraphSubset> areas;
+		for (std::vector<GraphSubset>::const_iterator i = _dirtyAreas.begin(); i != _dirtyAreas.end(); ++i)
+		{
+			GraphSubset area = GraphSubset::intersection(*i, screen);
+			if (area.size_x() > 0 && area.size_y() > 0)
+			{
+				areas.push_back(area);
+			}
+		}
+		// the merged areas don't overlap, so they can be drawn at the same time
+		drawTerrainAreas(areas);
+	}
+	_dirtyAreas.clear();
+}
+
+namespace
+{
+
+/**
+ * Areas of the map drawn by the threads of the pool.
+ */
+struct MapAreas
+{
+	Map *map;
+	const std::vector<GraphSubset> *areas;
+};
+
+/**
+ * Checks that no two areas share any pixels. Each area gets
+ * cleared and redrawn as a whole, so areas that overlap can't
+ * be drawn at the same time.
+ * @param areas Areas of the map.
+ * @return True if the areas are disjoint.
+ */
+bool areDisjoint(const std::vector<GraphSubset> &areas)
+{
+	for (size_t i = 0; i < areas.size(); ++i)
+	{
+		for (size_t j = i + 1; j < areas.size(); ++j)
+		{
+			GraphSubset common = GraphSubset::intersection(areas[i], areas[j]);
+			if (common.size_x() > 0 && common.size_y() > 0)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+}
+
+/**
+ * Draws one of the areas of a thread pool job.
+ * @param data Pointer to the MapAreas of the job.
+ * @param part Index of the area to draw.
+ */
+void Map::drawTerrainJob(void *data, int part)
+{
+	MapAreas *job = (MapAreas*)data;
+	job->map->drawTerrainArea((*job->areas)[part]);
+}
+
+/**
+ * Draws all tiles overlapping an area of the map through a surface sharing
+ * the map pixels, so nothing outside of the area can change.
+ * @param area Area of the map to draw, inside of the map.
+ */
+void Map::drawTerrainArea(const GraphSubset &area)
+{
+	Surface view(this, area.beg_x, area.beg_y, area.size_x(), area.size_y());
+	view.clear(Palette::blockOffset(0)+15);
+	drawTerrain(&view, Position(area.beg_x, area.beg_y, 0));
+}
+
+/**
+ * Draws areas of the map, spread over the render threads if there
+ * are any and the areas don't overlap, otherwise one after another.
+ * @param areas Areas of the map to draw.
+ */
+void Map::drawTerrainAreas(const std::vector<GraphSubset> &areas)
+{
+	if (_threadPool && areas.size() > 1 && areDisjoint(areas))
+	{
+		MapAreas job = { this, &areas };
+		_threadPool->run(drawTerrainJob, &job, areas.size());
+	}
+	else
+	{
+		for (std::vector<GraphSubset>::const_iterator i = areas.begin(); i != areas.end(); ++i)
+		{
+			drawTerrainArea(*i);
+		}
+	}
+}
+
+/**
+ * Redraws the dirty areas of the map before blitting it,
+ * or the whole map if it was invalidated.
+ * @param surface Pointer to surface to blit onto.
+ */
+void Map::blit(Surface *surface)
+{
+	// projectiles and explosions are animated by the battle states, which redraw everything anyway
+	if (!_redraw && !_projectile && _explosions.empty())
+	{
+		if (!canDrawDirtyAreas())
+		{
+			_redraw = true;
+		}
+		else if (!_dirtyAreas.empty())
+		{
+			drawDirtyAreas();
+		}
+	}
+	Surface::blit(surface);
+}
+
+/**
+ * Marks the screen area of a tile, with enough margin to cover
+ * the units, items and cursors drawn over it, for redrawing.
+ * @param pos Map position of the tile.
+ */
+void Map::invalidateTile(Position pos)
+{
+	Position screenPos;
+	_camera->convertMapToScreen(pos, &screenPos);
+	screenPos += _camera->getMapOffset();
+
+	GraphSubset area = GraphSubset(std::make_pair(screenPos.x - _spriteWidth / 2, screenPos.x + _spriteWidth * 3 / 2), std::make_pair(screenPos.y - _spriteHeight * 3 / 2, screenPos.y + _spriteHeight));
+	GraphSubset visible = GraphSubset::intersection(area, GraphSubset(getWidth(), getHeight()));
+	if (visible.size_x() > 0 && visible.size_y() > 0)
+	{
+		_dirtyAreas.push_back(visible);
+	}
+}
+
+/**
+ * Marks all tiles occupied by a unit for redrawing.
+ * @param unit Pointer to the unit.
+ */
+void Map::invalidateUnit(BattleUnit *unit)
+{
+	const int size = unit->getArmor()->getSize();
+	for (int x = 0; x < size; ++x)
+	{
+		for (int y = 0; y < size; ++y)
+		{
+			invalidateTile(unit->getPosition() + Position(x, y, 0));
+			if (unit->getStatus() == STATUS_WALKING || unit->getStatus() == STATUS_FLYING)
+			{
+				invalidateTile(unit->getDestination() + Position(x, y, 0));
+			}
+		}
+	}
+}
+
+/**
+ * Marks the tiles covered by the 3D cursor for redrawing,
+ * including the ones below the view level showing the blue box.
+ * @param x Map X position of the cursor.
+ * @param y Map Y position of the cursor.
+ */
+void Map::invalidateCursor(int x, int y)
+{
+	for (int itZ = 0; itZ <= _camera->getViewLevel(); ++itZ)
+	{
+		for (int itX = x - _cursorSize + 1; itX <= x; ++itX)
+		{
+			for (int itY = y - _cursorSize + 1; itY <= y; ++itY)
+			{
+				invalidateTile(Position(itX, itY, itZ));
+			}
+		}
+	}
+}
+
+/**
+ * Checks if a part of a tile changes its sprite over the animation frames.
+ * @param tile Pointer to the tile.
+ * @param part Part of the tile.
+ * @return True if the part is animated.
+ */
+static bool isAnimatedPart(Tile *tile, TilePart part)
+{
+	MapData *data = tile->getMapData(part);
+	if (data->isUFODoor())
+	{
+		return tile->isUfoDoorOpen(part);
+	}
+	for (int frame = 1; frame < 8; ++frame)
+	{
+		if (data->getSprite(frame) != data->getSprite(0))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Adds a value to a FNV-1a style checksum.
+ * @param hash Checksum to update.
+ * @param value Value to add.
+ */
+static inline void addToHash(Uint64 &hash, Uint64 value)
+{
+	hash = (hash ^ value) * 1099511628211ULL;
+}
+
+/**
+ * Draws the static terrain of the shown levels from the level caches and then
+ * redraws the areas around anything moving or animating the usual way, through
+ * the dirty areas. The cache of a level covers more than the screen, so it is
+ * only drawn again when the camera scrolls past its margin or the sprites or
+ * shades of its terrain change: destroyed terrain, opened doors, new lighting
+ * or discovered tiles.
+ * @param beginZ First level to draw.
+ * @param endZ Last level to draw.
+ */
+void Map::drawCachedTerrain(int beginZ, int endZ)
+{
+	const Position mapOffset = _camera->getMapOffset();
+	const int cacheWidth = getWidth() + getWidth() / 2;
+	const int cacheHeight = getHeight() + getHeight() / 2;
+	if (_terrainCache.empty())
+	{
+		_terrainCache.resize(_save->getMapSizeZ(), 0);
+		_terrainCacheOffset.resize(_save->getMapSizeZ());
+		_terrainCacheHash.resize(_save->getMapSizeZ(), 0);
+	}
+
+	for (int itZ = beginZ; itZ <= endZ; itZ++)
+	{
+		Surface *&cache = _terrainCache[itZ];
+		if (cache && (cache->getWidth() != cacheWidth || cache->getHeight() != cacheHeight))
+		{
+			delete cache;
+			cache = 0;
+		}
+		Position shift = mapOffset - _terrainCacheOffset[itZ];
+		bool scrolled = !cache || shift.x > 0 || shift.y > 0 || shift.x + cacheWidth < getWidth() || shift.y + cacheHeight < getHeight();
+		if (scrolled)
+		{
+			// center the cache on the screen again
+			_terrainCacheOffset[itZ] = mapOffset + Position((cacheWidth - getWidth()) / 2, (cacheHeight - getHeight()) / 2, 0);
+			shift = mapOffset - _terrainCacheOffset[itZ];
+		}
+		const Position cacheOffset = _terrainCacheOffset[itZ];
+
+		// same rough boundaries as drawTerrain, but for the cached area
+		int beginX, beginY, endX, endY, dummy;
+		_camera->setMapOffset(Position(cacheOffset.x, cacheOffset.y, mapOffset.z));
+		_camera->convertScreenToMap(0, 0, &beginX, &dummy);
+		_camera->convertScreenToMap(cacheWidth, 0, &dummy, &beginY);
+		_camera->convertScreenToMap(cacheWidth + _spriteWidth, cacheHeight + _spriteHeight, &endX, &dummy);
+		_camera->convertScreenToMap(0, cacheHeight + _spriteHeight, &dummy, &endY);
+		_camera->setMapOffset(mapOffset);
+		beginY = std::max(0, beginY - _camera->getViewLevel() * 2);
+		beginX = std::max(0, beginX - _camera->getViewLevel() * 2);
+
+		// checksum everything the cache is drawn from, and find the tiles it can't show
+		Uint64 hash = 14695981039346656037ULL;
+		for (int itX = beginX; itX <= endX; itX++)
+		{
+			for (int itY = beginY; itY <= endY; itY++)
+			{
+				Position mapPosition = Position(itX, itY, itZ);
+				Position cachePosition;
+				_camera->convertMapToScreen(mapPosition, &cachePosition);
+				cachePosition += cacheOffset;
+				if (cachePosition.x <= -_spriteWidth || cachePosition.x >= cacheWidth + _spriteWidth ||
+					cachePosition.y <= -_spriteHeight || cachePosition.y >= cacheHeight + _spriteHeight)
+				{
+					continue;
+				}
+				Tile *tile = _save->getTile(mapPosition);
+				if (!tile)
+				{
+					continue;
+				}
+				Tile *tileBelow = _save->getTile(mapPosition - Position(0,0,1));
+				bool dynamic = tile->getUnit() || (tileBelow && tileBelow->getUnit()) || tile->getTopItem() || tile->getSmoke() || !tile->getParticleCloud()->empty() || tile->getPreview() != -1;
+				const int tileShade = tile->isDiscovered(2) ? tile->getShade() : 16;
+				for (int part = O_FLOOR; part <= O_OBJECT; ++part)
+				{
+					TilePart tp = (TilePart)part;
+					if (!tile->getMapData(tp) || isAnimatedPart(tile, tp))
+					{
+						dynamic = dynamic || tile->getMapData(tp);
+						addToHash(hash, 0);
+						continue;
+					}
+					int shade = tileShade;
+					if (tp == O_WESTWALL)
+					{
+						shade = getWallShade(tp, tile, _save->getTile(mapPosition - Position(1,0,0)));
+					}
+					else if (tp == O_NORTHWALL)
+					{
+						shade = getWallShade(tp, tile, _save->getTile(mapPosition - Position(0,1,0)));
+					}
+					addToHash(hash, (Uint64)(size_t)tile->getSprite(tp));
+					addToHash(hash, tile->getMapData(tp)->getYOffset());
+					addToHash(hash, shade);
+				}
+				if (dynamic)
+				{
+					invalidateTile(mapPosition);
+				}
+			}
+		}
+
+		if (scrolled || hash != _terrainCacheHash[itZ])
+		{
+			if (!cache)
+			{
+				cache = new Surface(cacheWidth, cacheHeight);
+			}
+			drawTerrainCache(itZ, beginX, endX, beginY, endY);
+			_terrainCacheHash[itZ] = hash;
+		}
+		cache->blitNShade(this, -shift.x, -shift.y, 0);
+	}
+
+	// everything else drawn over the terrain
+	for (std::vector<BattleUnit*>::iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		if (!(*i)->isOut())
+		{
+			invalidateUnit(*i);
+		}
+	}
+	if (_cursorType != CT_NONE)
+	{
+		invalidateCursor(_selectorX, _selectorY);
+	}
+	for (std::vector<Position>::const_iterator i = _waypoints.begin(); i != _waypoints.end(); ++i)
+	{
+		invalidateTile(*i);
+	}
+	drawDirtyAreas();
+}
+
+/**
+ * Draws the floors, walls and objects of a map level that don't animate
+ * into its cache, in the same order drawTerrain uses.
+ * @param level Map level to draw.
+ * @param beginX First map column to draw.
+ * @param endX Last map column to draw.
+ * @param beginY First map row to draw.
+ * @param endY Last map row to draw.
+ */
+void Map::drawTerrainCache(int level, int beginX, int endX, int beginY, int endY)
+{
+	Surface *cache = _terrainCache[level];
+	const Position cacheOffset = _terrainCacheOffset[level];
+	Surface *tmpSurface;
+	Position mapPosition, screenPosition;
+
+	cache->clear();
+	cache->lock();
+	for (int itX = beginX; itX <= endX; itX++)
+	{
+		for (int itY = beginY; itY <= endY; itY++)
+		{
+			mapPosition = Position(itX, itY, level);
+			_camera->convertMapToScreen(mapPosition, &screenPosition);
+			screenPosition += cacheOffset;
+			if (screenPosition.x <= -_spriteWidth || screenPosition.x >= cache->getWidth() + _spriteWidth ||
+				screenPosition.y <= -_spriteHeight || screenPosition.y >= cache->getHeight() + _spriteHeight)
+			{
+				continue;
+			}
+			Tile *tile = _save->getTile(mapPosition);
+			if (!tile || tile->isVoid())
+			{
+				continue;
+			}
+			const int tileShade = tile->isDiscovered(2) ? tile->getShade() : 16;
+
+			tmpSurface = tile->getSprite(O_FLOOR);
+			if (tmpSurface && !isAnimatedPart(tile, O_FLOOR))
+			{
+				tmpSurface->blitNShade(cache, screenPosition.x, screenPosition.y - tile->getMapData(O_FLOOR)->getYOffset(), tileShade);
+			}
+			tmpSurface = tile->getSprite(O_WESTWALL);
+			if (tmpSurface && !isAnimatedPart(tile, O_WESTWALL))
+			{
+				tmpSurface->blitNShade(cache, screenPosition.x, screenPosition.y - tile->getMapData(O_WESTWALL)->getYOffset(), getWallShade(O_WESTWALL, tile, _save->getTile(mapPosition - Position(1,0,0))));
+			}
+			tmpSurface = tile->getSprite(O_NORTHWALL);
+			if (tmpSurface && !isAnimatedPart(tile, O_NORTHWALL))
+			{
+				tmpSurface->blitNShade(cache, screenPosition.x, screenPosition.y - tile->getMapData(O_NORTHWALL)->getYOffset(), getWallShade(O_NORTHWALL, tile, _save->getTile(mapPosition - Position(0,1,0))), tile->getMapData(O_WESTWALL));
+			}
+			tmpSurface = tile->getSprite(O_OBJECT);
+			if (tmpSurface && !isAnimatedPart(tile, O_OBJECT))
+			{
+				tmpSurface->blitNShade(cache, screenPosition.x, screenPosition.y - tile->getMapData(O_OBJECT)->getYOffset(), tileShade);
+			}
+		}
+	}
+	cache->unlock();
 }
 
 /**
@@ -465,9 +948,11 @@ void Map::drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Posit
 		return;
 	}
 
-	Position tileScreenPosition;
+	// position of the unit tile relative to the current one, as the surface drawn on can be a part of the map
+	Position tileScreenPosition, currTileMapScreenPosition;
 	_camera->convertMapToScreen(unitTile->getPosition() + Position(0,0, unitFromBelow ? -1 : 0), &tileScreenPosition);
-	tileScreenPosition += _camera->getMapOffset();
+	_camera->convertMapToScreen(currTile->getPosition(), &currTileMapScreenPosition);
+	tileScreenPosition += currTileScreenPosition - currTileMapScreenPosition;
 
 	// draw unit
 	Position offset;
@@ -481,9 +966,12 @@ void Map::drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Posit
 /**
  * Draw the terrain.
  * Keep this function as optimised as possible. It's big to minimise overhead of function calls.
+ * Projectiles and explosions are only drawn on the whole map, parts of the map drawn
+ * through smaller surfaces must be safe to draw on several threads at once.
  * @param surface The surface to draw on.
+ * @param viewOffset Position of the surface on the map, if it is only a part of it.
  */
-void Map::drawTerrain(Surface *surface)
+void Map::drawTerrain(Surface *surface, Position viewOffset)
 {
 	int frameNumber = 0;
 	Surface *tmpSurface;
@@ -607,10 +1095,11 @@ void Map::drawTerrain(Surface *surface)
 	}
 
 	// get corner map coordinates to give rough boundaries in which tiles to redraw are
-	_camera->convertScreenToMap(0, 0, &beginX, &dummy);
-	_camera->convertScreenToMap(surface->getWidth(), 0, &dummy, &beginY);
-	_camera->convertScreenToMap(surface->getWidth() + _spriteWidth, surface->getHeight() + _spriteHeight, &endX, &dummy);
-	_camera->convertScreenToMap(0, surface->getHeight() + _spriteHeight, &dummy, &endY);
+	const Position mapOffset = _camera->getMapOffset() - viewOffset;
+	_camera->convertScreenToMap(viewOffset.x, viewOffset.y, &beginX, &dummy);
+	_camera->convertScreenToMap(viewOffset.x + surface->getWidth(), viewOffset.y, &dummy, &beginY);
+	_camera->convertScreenToMap(viewOffset.x + surface->getWidth() + _spriteWidth, viewOffset.y + surface->getHeight() + _spriteHeight, &endX, &dummy);
+	_camera->convertScreenToMap(viewOffset.x, viewOffset.y + surface->getHeight() + _spriteHeight, &dummy, &endY);
 	beginY -= (_camera->getViewLevel() * 2);
 	beginX -= (_camera->getViewLevel() * 2);
 	if (beginX < 0)
@@ -627,8 +1116,31 @@ void Map::drawTerrain(Surface *surface)
 		_numWaypid->setColor(pathfinderTurnedOn ? _messageColor + 1 : Palette::blockOffset(1));
 	}
 
+	// when drawing the whole map the terrain comes from the level caches,
+	// only the dirty areas around moving things go through the loop below
+	const bool cached = surface == this && !_projectile && _explosions.empty();
+	// otherwise it can be drawn in horizontal bands by the render threads,
+	// except for projectiles which need the voxel checks of the tile engine
+	const bool banded = surface == this && !cached && !_projectile && _threadPool;
+	if (cached)
+	{
+		drawCachedTerrain(beginZ, endZ);
+	}
+	else if (banded)
+	{
+		// more bands than threads, the rows with the most tiles take longer
+		const int bands = _threadPool->getThreads() * 2;
+		const int bandHeight = (surface->getHeight() + bands - 1) / bands;
+		std::vector<GraphSubset> areas;
+		for (int y = 0; y < surface->getHeight(); y += bandHeight)
+		{
+			areas.push_back(GraphSubset(std::make_pair(0, surface->getWidth()), std::make_pair(y, std::min(y + bandHeight, surface->getHeight()))));
+		}
+		drawTerrainAreas(areas);
+	}
+
 	surface->lock();
-	for (int itZ = beginZ; itZ <= endZ; itZ++)
+	for (int itZ = beginZ; itZ <= endZ && !cached && !banded; itZ++)
 	{
 		bool topLayer = itZ == endZ;
 		for (int itX = beginX; itX <= endX; itX++)
@@ -637,7 +1149,7 @@ void Map::drawTerrain(Surface *surface)
 			{
 				mapPosition = Position(itX, itY, itZ);
 				_camera->convertMapToScreen(mapPosition, &screenPosition);
-				screenPosition += _camera->getMapOffset();
+				screenPosition += mapOffset;
 
 				// only render cells that are inside the surface
 				if (screenPosition.x > -_spriteWidth && screenPosition.x < surface->getWidth() + _spriteWidth &&
@@ -965,6 +1477,8 @@ void Map::drawTerrain(Surface *surface)
 							// UFO extender accuracy: display adjusted accuracy value on crosshair in real-time.
 							if (_cursorType == CT_AIM && Options::battleUFOExtenderAccuracy)
 							{
+								// the text is shared by all threads drawing the map
+								SDL_LockMutex(_txtAccuracyLock);
 								BattleAction *action = _save->getBattleGame()->getCurrentAction();
 								const RuleItem *weapon = action->weapon->getRules();
 								std::ostringstream ss;
@@ -1032,6 +1546,7 @@ void Map::drawTerrain(Surface *surface)
 								_txtAccuracy->setText(Language::utf8ToWstr(ss.str()));
 								_txtAccuracy->draw();
 								_txtAccuracy->blitNShade(surface, screenPosition.x, screenPosition.y, 0);
+								SDL_UnlockMutex(_txtAccuracyLock);
 							}
 						}
 						else if (_camera->getViewLevel() > itZ)
@@ -1096,7 +1611,7 @@ void Map::drawTerrain(Surface *surface)
 				{
 					mapPosition = Position(itX, itY, itZ);
 					_camera->convertMapToScreen(mapPosition, &screenPosition);
-					screenPosition += _camera->getMapOffset();
+					screenPosition += mapOffset;
 
 					// only render cells that are inside the surface
 					if (screenPosition.x > -_spriteWidth && screenPosition.x < surface->getWidth() + _spriteWidth &&
@@ -1160,7 +1675,7 @@ void Map::drawTerrain(Surface *surface)
 	if (unit && (_save->getSide() == FACTION_PLAYER || _save->getDebugMode()) && unit->getPosition().z <= _camera->getViewLevel())
 	{
 		_camera->convertMapToScreen(unit->getPosition(), &screenPosition);
-		screenPosition += _camera->getMapOffset();
+		screenPosition += mapOffset;
 		Position offset;
 		calculateWalkingOffset(unit, &offset);
 		if (unit->getArmor()->getSize() > 1)
@@ -1180,7 +1695,7 @@ void Map::drawTerrain(Surface *surface)
 	delete _numWaypid;
 
 	// check if we got big explosions
-	if (_explosionInFOV)
+	if (_explosionInFOV && surface == this)
 	{
 		// big explosions cause the screen to flash as bright as possible before any explosions are actually drawn.
 		// this causes everything to look like EGA for a single frame.
@@ -1298,12 +1813,14 @@ void Map::setSelectorPosition(int mx, int my)
 
 	if (oldX != _selectorX || oldY != _selectorY)
 	{
-		_redraw = true;
+		invalidateCursor(oldX, oldY);
+		invalidateCursor(_selectorX, _selectorY);
 	}
 }
 
 /**
  * Handles animating tiles. 8 Frames per animation.
+ * Only the tiles that look different afterwards are marked for redrawing.
  * @param redraw Redraw the battlescape?
  */
 void Map::animate(bool redraw)
@@ -1311,10 +1828,17 @@ void Map::animate(bool redraw)
 	_save->nextAnimFrame();
 	_animFrame = _save->getAnimFrame();
 
+	// smoke and fire advance every second frame
+	const bool smokeFrame = (_animFrame % 2) == 0;
+
 	// animate tiles
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
 	{
-		_save->getTile(i)->animate();
+		Tile *tile = _save->getTile(i);
+		if ((tile->animate() || (smokeFrame && tile->getSmoke())) && redraw)
+		{
+			invalidateTile(tile->getPosition());
+		}
 	}
 
 	// animate certain units (large flying units have a propulsion animation)
@@ -1324,9 +1848,18 @@ void Map::animate(bool redraw)
 		{
 			(*i)->breathe();
 		}
+		// unit sprites and scripts can use the animation frame too
+		if (redraw && !(*i)->isOut() && ((*i)->getVisible() || _save->getDebugMode()))
+		{
+			invalidateUnit(*i);
+		}
 	}
 
-	if (redraw) _redraw = true;
+	// cursor is animated too
+	if (redraw && _cursorType != CT_NONE)
+	{
+		invalidateCursor(_selectorX, _selectorY);
+	}
 }
 
 /**
@@ -37,6 +37,7 @@ class Timer;
 class Text;
 class Tile;
 class UnitSprite;
+class ThreadPool;
 
 enum CursorType { CT_NONE, CT_NORMAL, CT_AIM, CT_PSI, CT_WAYPOINT, CT_THROW };
 enum TilePart : int;
@@ -71,9 +72,27 @@ private:
 	PathPreview _previewSetting;
 	Text *_txtAccuracy;
 	SurfaceSet *_projectileSet;
+	std::vector<GraphSubset> _dirtyAreas;
+	Position _drawnMapOffset;
+	bool _drawnAllLayers, _drawnTerrain;
+	BattleUnit *_drawnSelectedUnit;
+	std::vector<Surface*> _terrainCache;
+	std::vector<Position> _terrainCacheOffset;
+	std::vector<Uint64> _terrainCacheHash;
+	ThreadPool *_threadPool;
+	SDL_mutex *_txtAccuracyLock;
 
 	void drawUnit(UnitSprite &unitSprite, Tile *unitTile, Tile *currTile, Position tileScreenPosition, int shade, bool topLayer);
-	void drawTerrain(Surface *surface);
+	void drawTerrain(Surface *surface, Position viewOffset);
+	void drawTerrainArea(const GraphSubset &area);
+	void drawTerrainAreas(const std::vector<GraphSubset> &areas);
+	static void drawTerrainJob(void *data, int part);
+	bool canDrawTerrain() const;
+	bool canDrawDirtyAreas() const;
+	void drawDirtyAreas();
+	void drawCachedTerrain(int beginZ, int endZ);
+	void drawTerrainCache(int level, int beginX, int endX, int beginY, int endY);
+	void invalidateCursor(int x, int y);
 	int getTerrainLevel(const Position& pos, int size) const;
 	int getWallShade(TilePart part, Tile* tileFrot, Tile* tileBehind);
 	int _iconHeight, _iconWidth, _messageColor;
@@ -89,6 +108,12 @@ public:
 	void think();
 	/// Draws the surface.
 	void draw();
+	/// Blits the surface, redrawing the dirty areas first.
+	void blit(Surface *surface);
+	/// Marks a tile for redrawing.
+	void invalidateTile(Position pos);
+	/// Marks the tiles of a unit for redrawing.
+	void invalidateUnit(BattleUnit *unit);
 	/// Sets the palette.
 	void setPalette(SDL_Color *colors, int firstcolor = 0, int ncolors = 256);
 	/// Special handling for mouse press.
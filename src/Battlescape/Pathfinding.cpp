@@ -18,6 +18,7 @@
  */
 #include <list>
 #include <algorithm>
+#include <unordered_set>
 #include "Pathfinding.h"
 #include "PathfindingOpenSet.h"
 #include "../Savegame/SavedBattleGame.h"
@@ -25,6 +26,7 @@
 #include "../Mod/Armor.h"
 #include "../Savegame/BattleUnit.h"
 #include "../Engine/Options.h"
+#include "../Engine/Profiler.h"
 #include "BattlescapeGame.h"
 
 namespace OpenXcom
@@ -42,7 +44,7 @@ int Pathfinding::green = 4;
  * Sets up a Pathfinding.
  * @param save pointer to SavedBattleGame object.
  */
-Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK)
+Pathfinding::Pathfinding(SavedBattleGame *save) : _save(save), _unit(0), _pathPreviewed(false), _strafeMove(false), _totalTUCost(0), _modifierUsed(false), _movementType(MT_WALK), _ignoreUnits(false), _clusters(save)
 {
 	_size = _save->getMapSizeXYZ();
 	// Initialize one node per tile
@@ -83,12 +85,14 @@ PathfindingNode *Pathfinding::getNode(Position pos)
  */
 void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *target, int maxTUCost)
 {
+	Profiler profile(Profiler::PROFILE_PATHFINDING);
 	_totalTUCost = 0;
 	_path.clear();
 	// i'm DONE with these out of bounds errors.
 	if (endPosition.x > _save->getMapSizeX() - unit->getArmor()->getSize() || endPosition.y > _save->getMapSizeY() - unit->getArmor()->getSize() || endPosition.x < 0 || endPosition.y < 0) return;
 
 	bool sneak = Options::sneakyAI && unit->getFaction() == FACTION_HOSTILE;
+	bool missile = false;
 
 	Position startPosition = unit->getPosition();
 	_movementType = unit->getMovementType();
@@ -96,6 +100,7 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	{
 		_movementType = MT_FLY;
 		maxTUCost = 10000;
+		missile = true;
 	}
 	_unit = unit;
 
@@ -175,6 +180,17 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
 	{
 		abortPath(); // if bresenham failed, we shouldn't keep the path it was attempting, in case A* fails too.
 	}
+	// long walks of units the player doesn't steer first try A* in a corridor of map clusters,
+	// if it finds nothing within the TU budget there we search the whole map.
+	if (!missile && unit->getFaction() != FACTION_PLAYER && _clusters.isLongPath(startPosition, endPosition) &&
+		_clusters.findCorridor(this, unit, startPosition, endPosition))
+	{
+		if (aStarPath(startPosition, endPosition, target, sneak, maxTUCost, true))
+		{
+			return;
+		}
+		abortPath();
+	}
 	// Now try through A*.
 	if (!aStarPath(startPosition, endPosition, target, sneak, maxTUCost))
 	{
@@ -191,13 +207,32 @@ void Pathfinding::calculate(BattleUnit *unit, Position endPosition, BattleUnit *
  * @param target Target of the path.
  * @param sneak Is the unit sneaking?
  * @param maxTUCost Maximum time units the path can cost.
+ * @param inCorridor Only search the corridor found by the last PathfindingClusters::findCorridor().
  * @return True if a path exists, false otherwise.
  */
-bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost)
+bool Pathfinding::aStarPath(Position startPosition, Position endPosition, BattleUnit *target, bool sneak, int maxTUCost, bool inCorridor)
 {
-	// reset every node, so we have to check them all
-	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
-		it->reset();
+	if (inCorridor)
+	{
+		// reset the nodes of the corridor, no others can be reached
+		for (int cluster = 0; cluster < _clusters.getClusterCount(); ++cluster)
+		{
+			if (!_clusters.isCorridorCluster(cluster))
+				continue;
+			Position from, to;
+			_clusters.getClusterArea(cluster, from, to);
+			for (int z = from.z; z <= to.z; ++z)
+				for (int y = from.y; y <= to.y; ++y)
+					for (int x = from.x; x <= to.x; ++x)
+						getNode(Position(x, y, z))->reset();
+		}
+	}
+	else
+	{
+		// reset every node, so we have to check them all
+		for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+			it->reset();
+	}
 
 	// start position is the first one in our "open" list
 	PathfindingNode *start = getNode(startPosition);
@@ -227,6 +262,14 @@ bool Pathfinding::aStarPath(Position startPosition, Position endPosition, Battle
 		for (int direction = 0; direction < 10; direction++)
 		{
 			Position nextPos;
+			if (inCorridor)
+			{
+				// steps can't leave the corridor, falling or climbing stays in the same cluster
+				Position vector;
+				directionToVector(direction, &vector);
+				if (!_save->getTile(currentPos + vector) || !_clusters.isInCorridor(currentPos + vector))
+					continue;
+			}
 			int tuCost = getTUCost(currentPos, direction, &nextPos, _unit, target, missile);
 			if (tuCost >= 255) // Skip unreachable / blocked
 				continue;
@@ -335,7 +378,7 @@ int Pathfinding::getTUCost(Position startPosition, int direction, Position *endP
 						fellDown = true;
 					}
 			}
-			else if (!missile && _movementType == MT_FLY && belowDestination && belowDestination->getUnit() && belowDestination->getUnit() != unit)
+			else if (!missile && _movementType == MT_FLY && !_ignoreUnits && belowDestination && belowDestination->getUnit() && belowDestination->getUnit() != unit)
 			{
 				// 2 or more voxels poking into this tile = no go
 				if (belowDestination->getUnit()->getHeight() + belowDestination->getUnit()->getFloatHeight() - belowDestination->getTerrainLevel() > 26)
@@ -590,7 +633,7 @@ bool Pathfinding::isBlocked(Tile *tile, const int part, BattleUnit *missileTarge
 			tileNorth->getMapData(O_OBJECT)->getBigWall() == BIGWALLEASTANDSOUTH))
 			return true; // blocking part
 	}
-	if (part == O_FLOOR)
+	if (part == O_FLOOR && !_ignoreUnits)
 	{
 		if (tile->getUnit())
 		{
@@ -1119,12 +1162,13 @@ bool Pathfinding::bresenhamPath(Position origin, Position target, BattleUnit *ta
  * Locates all tiles reachable to @a *unit with a TU cost no more than @a tuMax.
  * Uses Dijkstra's algorithm.
  * @param unit Pointer to the unit.
- * @param tuMax The maximum cost of the path to each tile.
- * @return An array of reachable tiles, sorted in ascending order of cost. The first tile is the start location.
+ * @param cost The time units and energy to keep for an action after moving.
+ * @param tiles Receives the reachable tiles with their costs and previous steps, sorted in ascending order of cost. The first tile is the start location.
  */
-std::vector<int> Pathfinding::findReachable(BattleUnit *unit, const BattleActionCost &cost)
+void Pathfinding::findReachable(BattleUnit *unit, const BattleActionCost &cost, ReachableTiles &tiles)
 {
 	const Position start = unit->getPosition();
+	_movementType = unit->getMovementType();
 	int tuMax = unit->getTimeUnits() - cost.Time;
 	int energyMax = unit->getEnergy() - cost.Energy;
 	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
@@ -1166,13 +1210,98 @@ std::vector<int> Pathfinding::findReachable(BattleUnit *unit, const BattleAction
 		reachable.push_back(currentNode);
 	}
 	std::sort(reachable.begin(), reachable.end(), MinNodeCosts());
-	std::vector<int> tiles;
-	tiles.reserve(reachable.size());
+	tiles.reset(_save->getMapSizeXYZ());
 	for (std::vector<PathfindingNode*>::const_iterator it = reachable.begin(); it != reachable.end(); ++it)
 	{
-		tiles.push_back(_save->getTileIndex((*it)->getPosition()));
+		PathfindingNode *prevNode = (*it)->getPrevNode();
+		tiles.add(_save->getTileIndex((*it)->getPosition()), (*it)->getTUCost(false), prevNode ? _save->getTileIndex(prevNode->getPosition()) : -1);
+	}
+}
+
+/**
+ * Gets the TU costs for @a *unit to reach each of a list of positions.
+ * Uses one Dijkstra expansion from the unit for all of them, which stops
+ * as soon as every target has its final cost, instead of one A* per target.
+ * @param unit Pointer to the unit.
+ * @param targets Positions to reach.
+ * @param maxTUCost Maximum time units a path can cost, the search doesn't go any further.
+ * @return TU cost for each target, in the same order, -1 if it can't be reached,
+ * or maxTUCost + 1 if the search ran out of time units before finding out.
+ */
+std::vector<int> Pathfinding::findCostsTo(BattleUnit *unit, const std::vector<Position> &targets, int maxTUCost)
+{
+	std::vector<int> costs(targets.size(), -1);
+	std::unordered_set<int> pending;
+	for (std::vector<Position>::const_iterator i = targets.begin(); i != targets.end(); ++i)
+	{
+		if (_save->getTile(*i))
+		{
+			pending.insert(_save->getTileIndex(*i));
+		}
+	}
+	if (pending.empty())
+	{
+		return costs;
+	}
+
+	_movementType = unit->getMovementType();
+	for (std::vector<PathfindingNode>::iterator it = _nodes.begin(); it != _nodes.end(); ++it)
+	{
+		it->reset();
+	}
+	PathfindingNode *startNode = getNode(unit->getPosition());
+	startNode->connect(0, 0, 0);
+	PathfindingOpenSet unvisited;
+	unvisited.push(startNode);
+	bool outOfTUs = false;
+	while (!unvisited.empty())
+	{
+		PathfindingNode *currentNode = unvisited.pop();
+		Position const &currentPos = currentNode->getPosition();
+		currentNode->setChecked();
+		// the cheapest way to this node is final now, stop when it was the last target
+		if (pending.erase(_save->getTileIndex(currentPos)) && pending.empty())
+		{
+			break;
+		}
+
+		// Try all reachable neighbours.
+		for (int direction = 0; direction < 10; direction++)
+		{
+			Position nextPos;
+			int tuCost = getTUCost(currentPos, direction, &nextPos, unit, 0, false);
+			if (tuCost >= 255) // Skip unreachable / blocked
+				continue;
+			PathfindingNode *nextNode = getNode(nextPos);
+			if (nextNode->isChecked()) // Our algorithm means this node is already at minimum cost.
+				continue;
+			int totalTuCost = currentNode->getTUCost(false) + tuCost;
+			if (totalTuCost > maxTUCost)
+			{
+				outOfTUs = true;
+				continue;
+			}
+			// If this node is unvisited or visited from a better path.
+			if (!nextNode->inOpenSet() || nextNode->getTUCost(false) > totalTuCost)
+			{
+				nextNode->connect(totalTuCost, currentNode, direction);
+				unvisited.push(nextNode);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < targets.size(); ++i)
+	{
+		if (_save->getTile(targets[i]) && getNode(targets[i])->isChecked())
+		{
+			costs[i] = getNode(targets[i])->getTUCost(false);
+		}
+		else if (outOfTUs)
+		{
+			costs[i] = maxTUCost + 1;
+		}
 	}
-	return tiles;
+	return costs;
 }
 
 /**
@@ -20,6 +20,8 @@
 #include <vector>
 #include "Position.h"
 #include "PathfindingNode.h"
+#include "ReachableTiles.h"
+#include "PathfindingClusters.h"
 #include "../Mod/MapData.h"
 
 namespace OpenXcom
@@ -50,6 +52,8 @@ private:
 	int _totalTUCost;
 	bool _modifierUsed;
 	MovementType _movementType;
+	bool _ignoreUnits;
+	PathfindingClusters _clusters;
 	/// Gets the node at certain position.
 	PathfindingNode *getNode(Position pos);
 	/// Determines whether a tile blocks a certain movementType.
@@ -57,7 +61,7 @@ private:
 	/// Tries to find a straight line path between two positions.
 	bool bresenhamPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
 	/// Tries to find a path between two positions.
-	bool aStarPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000);
+	bool aStarPath(Position origin, Position target, BattleUnit *missileTarget, bool sneak = false, int maxTUCost = 1000, bool inCorridor = false);
 	/// Determines whether a unit can fall down from this tile.
 	bool canFallDown(Tile *destinationTile) const;
 	/// Determines whether a unit can fall down from this tile.
@@ -130,7 +134,11 @@ public:
 	/// Sets _unit in order to abuse low-level pathfinding functions from outside the class.
 	void setUnit(BattleUnit *unit);
 	/// Gets all reachable tiles, based on cost.
-	std::vector<int> findReachable(BattleUnit *unit, const BattleActionCost &cost);
+	void findReachable(BattleUnit *unit, const BattleActionCost &cost, ReachableTiles &tiles);
+	/// Gets the TU costs to reach several positions, with one search.
+	std::vector<int> findCostsTo(BattleUnit *unit, const std::vector<Position> &targets, int maxTUCost = 1000);
+	/// Sets if steps ignore the units standing in the way, for costs that outlive their positions.
+	void setIgnoreUnits(bool ignore) { _ignoreUnits = ignore; }
 	/// Gets _totalTUCost; finds out whether we can hike somewhere in this turn or not.
 	int getTotalTUCost() const { return _totalTUCost; }
 	/// Gets the path preview setting.
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include "PathfindingClusters.h"
+#include "Pathfinding.h"
+#include "TileEngine.h"
+#include "../Savegame/SavedBattleGame.h"
+#include "../Savegame/BattleUnit.h"
+#include "../Mod/Armor.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Sets up the clusters of a battle map.
+ * @param save Pointer to SavedBattleGame object.
+ */
+PathfindingClusters::PathfindingClusters(SavedBattleGame *save) : _save(save), _turn(-1), _terrainChanges(-1)
+{
+	_sizeX = (_save->getMapSizeX() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	_sizeY = (_save->getMapSizeY() + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	_layers.resize((MT_SINK + 1) * 2);
+	_corridor.assign(getClusterCount(), 0);
+	invalidate();
+}
+
+/**
+ * Deletes the clusters.
+ */
+PathfindingClusters::~PathfindingClusters()
+{
+
+}
+
+/**
+ * Drops the border crossings of all layers, they get found again when needed.
+ */
+void PathfindingClusters::invalidate()
+{
+	for (std::vector<Layer>::iterator i = _layers.begin(); i != _layers.end(); ++i)
+	{
+		i->valid.assign(getClusterCount(), 0);
+	}
+}
+
+/**
+ * Drops the border crossings of the clusters a terrain change touched.
+ * Steps across a border also look at the tiles next to it, and large
+ * units at one more, so the area is widened before finding the clusters.
+ * @param area Map area of the terrain change.
+ */
+void PathfindingClusters::invalidateArea(GraphSubset area)
+{
+	const int margin = 2;
+	int fromX = std::max(area.beg_x - margin, 0) / CLUSTER_SIZE;
+	int fromY = std::max(area.beg_y - margin, 0) / CLUSTER_SIZE;
+	int toX = std::min((area.end_x + margin - 1) / CLUSTER_SIZE, _sizeX - 1);
+	int toY = std::min((area.end_y + margin - 1) / CLUSTER_SIZE, _sizeY - 1);
+	for (std::vector<Layer>::iterator i = _layers.begin(); i != _layers.end(); ++i)
+	{
+		for (int y = fromY; y <= toY; ++y)
+		{
+			for (int x = fromX; x <= toX; ++x)
+			{
+				i->valid[y * _sizeX + x] = 0;
+			}
+		}
+	}
+}
+
+/**
+ * Gets the tile area of a cluster, over all levels of the map.
+ * @param cluster Cluster index.
+ * @param from First position in the cluster.
+ * @param to Last position in the cluster.
+ */
+void PathfindingClusters::getClusterArea(int cluster, Position &from, Position &to) const
+{
+	from.x = (cluster % _sizeX) * CLUSTER_SIZE;
+	from.y = (cluster / _sizeX) * CLUSTER_SIZE;
+	from.z = 0;
+	to.x = std::min(from.x + CLUSTER_SIZE, _save->getMapSizeX()) - 1;
+	to.y = std::min(from.y + CLUSTER_SIZE, _save->getMapSizeY()) - 1;
+	to.z = _save->getMapSizeZ() - 1;
+}
+
+/**
+ * Gets the number of clusters the map is cut into.
+ * @return Number of clusters.
+ */
+int PathfindingClusters::getClusterCount() const
+{
+	return _sizeX * _sizeY;
+}
+
+/**
+ * Checks if a path crosses enough clusters to be worth searching a corridor first.
+ * Paths to the same or a neighbouring cluster are left to the exact search.
+ * @param start Start position.
+ * @param end End position.
+ * @return True if the path is long.
+ */
+bool PathfindingClusters::isLongPath(Position start, Position end) const
+{
+	int dx = std::abs(start.x / CLUSTER_SIZE - end.x / CLUSTER_SIZE);
+	int dy = std::abs(start.y / CLUSTER_SIZE - end.y / CLUSTER_SIZE);
+	return std::max(dx, dy) >= 2;
+}
+
+/**
+ * Finds the cheapest step across each border between neighbouring clusters,
+ * for the clusters whose crossings are out of date. The steps are checked with
+ * the real TU costs of the unit, so they include stairs, doors and walls, but
+ * not units: they move all the time and the exact search goes around them.
+ * @param layer Layer to fill.
+ * @param pathfinding Pathfinding with the movement type of the unit set.
+ * @param unit Unit taking the path.
+ */
+void PathfindingClusters::buildLayer(Layer &layer, Pathfinding *pathfinding, BattleUnit *unit)
+{
+	layer.crossing.resize(getClusterCount() * 4, -1);
+	pathfinding->setIgnoreUnits(true);
+	for (int cluster = 0; cluster < getClusterCount(); ++cluster)
+	{
+		if (layer.valid[cluster])
+		{
+			continue;
+		}
+		Position from, to;
+		getClusterArea(cluster, from, to);
+		for (int side = 0; side < 4; ++side)
+		{
+			// north, east, south and west are directions 0, 2, 4 and 6
+			int direction = side * 2;
+			Position vector;
+			Pathfinding::directionToVector(direction, &vector);
+			int nx = cluster % _sizeX + vector.x;
+			int ny = cluster / _sizeX + vector.y;
+			if (nx < 0 || ny < 0 || nx >= _sizeX || ny >= _sizeY)
+			{
+				continue;
+			}
+			int neighbour = ny * _sizeX + nx;
+			// the row or column of tiles along this border
+			Position borderFrom = from, borderTo = to;
+			if (vector.x > 0) borderFrom.x = to.x;
+			if (vector.x < 0) borderTo.x = from.x;
+			if (vector.y > 0) borderFrom.y = to.y;
+			if (vector.y < 0) borderTo.y = from.y;
+
+			int best = -1;
+			for (int z = borderFrom.z; z <= borderTo.z; ++z)
+			{
+				for (int y = borderFrom.y; y <= borderTo.y; ++y)
+				{
+					for (int x = borderFrom.x; x <= borderTo.x; ++x)
+					{
+						Position end;
+						int cost = pathfinding->getTUCost(Position(x, y, z), direction, &end, unit, 0, false);
+						if (cost < 255 && getCluster(end) == neighbour && (best == -1 || cost < best))
+						{
+							best = cost;
+						}
+					}
+				}
+			}
+			layer.crossing[cluster * 4 + side] = best;
+		}
+		layer.valid[cluster] = 1;
+	}
+	pathfinding->setIgnoreUnits(false);
+}
+
+/**
+ * Finds the clusters a path between two positions should go through.
+ * Searches the cluster graph for the cheapest chain of clusters, then widens
+ * it by the clusters around it, so the exact search has room to go around
+ * units and other obstacles the border crossings don't know about.
+ * The result is used by isInCorridor().
+ * @param pathfinding Pathfinding with the movement type of the unit set.
+ * @param unit Unit taking the path.
+ * @param start Start position.
+ * @param end End position.
+ * @return True if a corridor was found.
+ */
+bool PathfindingClusters::findCorridor(Pathfinding *pathfinding, BattleUnit *unit, Position start, Position end)
+{
+	// a new turn spreads fire around and drops everything found so far,
+	// terrain changes only drop the clusters they touched
+	TileEngine *tileEngine = _save->getTileEngine();
+	if (_turn != _save->getTurn())
+	{
+		invalidate();
+		_turn = _save->getTurn();
+		_terrainChanges = tileEngine->getTerrainChanges();
+	}
+	while (_terrainChanges < tileEngine->getTerrainChanges())
+	{
+		GraphSubset area(0, 0);
+		if (!tileEngine->getTerrainChangeArea(++_terrainChanges, area))
+		{
+			// too many changes to keep track of
+			invalidate();
+			_terrainChanges = tileEngine->getTerrainChanges();
+			break;
+		}
+		invalidateArea(area);
+	}
+	Layer &layer = _layers[unit->getMovementType() * 2 + (unit->getArmor()->getSize() > 1 ? 1 : 0)];
+	buildLayer(layer, pathfinding, unit);
+
+	const int startCluster = getCluster(start);
+	const int endCluster = getCluster(end);
+	std::vector<int> cost(getClusterCount(), -1);
+	std::vector<int> prev(getClusterCount(), -1);
+	std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int> >, std::greater<std::pair<int, int> > > open;
+	cost[startCluster] = 0;
+	open.push(std::make_pair(0, startCluster));
+	while (!open.empty())
+	{
+		std::pair<int, int> current = open.top();
+		open.pop();
+		int cluster = current.second;
+		if (current.first > cost[cluster])
+		{
+			continue;
+		}
+		if (cluster == endCluster)
+		{
+			break;
+		}
+		for (int side = 0; side < 4; ++side)
+		{
+			int crossing = layer.crossing[cluster * 4 + side];
+			if (crossing < 0)
+			{
+				continue;
+			}
+			Position vector;
+			Pathfinding::directionToVector(side * 2, &vector);
+			int neighbour = (cluster / _sizeX + vector.y) * _sizeX + cluster % _sizeX + vector.x;
+			// walking through a cluster takes about its width in steps like the one across its border
+			int next = current.first + std::max(crossing, 1) * CLUSTER_SIZE;
+			if (cost[neighbour] == -1 || next < cost[neighbour])
+			{
+				cost[neighbour] = next;
+				prev[neighbour] = cluster;
+				open.push(std::make_pair(next, neighbour));
+			}
+		}
+	}
+	if (cost[endCluster] == -1)
+	{
+		return false;
+	}
+
+	std::fill(_corridor.begin(), _corridor.end(), 0);
+	for (int cluster = endCluster; cluster != -1; cluster = prev[cluster])
+	{
+		int cx = cluster % _sizeX;
+		int cy = cluster / _sizeX;
+		for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, _sizeY - 1); ++y)
+		{
+			for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, _sizeX - 1); ++x)
+			{
+				_corridor[y * _sizeX + x] = 1;
+			}
+		}
+	}
+	return true;
+}
+
+}
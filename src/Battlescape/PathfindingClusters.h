@@ -0,0 +1,112 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include "Position.h"
+#include "../Engine/GraphSubset.h"
+
+namespace OpenXcom
+{
+
+class SavedBattleGame;
+class Pathfinding;
+class BattleUnit;
+
+/**
+ * A coarse layer over the battlescape map for long paths.
+ * The map is cut into square clusters spanning all levels, and for every
+ * movement type and unit size the borders between neighbouring clusters
+ * keep the cheapest step across them. Searching this small graph gives a
+ * corridor of clusters, which Pathfinding then searches exactly instead
+ * of flooding the whole map.
+ */
+class PathfindingClusters
+{
+public:
+	/// Width and length of a cluster in tiles.
+	static const int CLUSTER_SIZE = 10;
+private:
+	/**
+	 * Border crossings for one movement type and unit size.
+	 */
+	struct Layer
+	{
+		/// Are the crossings of each cluster up to date?
+		std::vector<char> valid;
+		/// Cheapest step from a cluster to its neighbour in each of the four cardinal directions, or -1.
+		std::vector<int> crossing;
+	};
+	SavedBattleGame *_save;
+	int _sizeX, _sizeY;
+	int _turn, _terrainChanges;
+	std::vector<Layer> _layers;
+	std::vector<char> _corridor;
+	/// Finds the border crossings of a layer that are out of date.
+	void buildLayer(Layer &layer, Pathfinding *pathfinding, BattleUnit *unit);
+	/// Drops the border crossings of the clusters around a map area.
+	void invalidateArea(GraphSubset area);
+public:
+	/// Creates the clusters of a battle map.
+	PathfindingClusters(SavedBattleGame *save);
+	/// Cleans up the clusters.
+	~PathfindingClusters();
+	/// Drops all border crossings.
+	void invalidate();
+
+	/**
+	 * Gets the cluster a position is in.
+	 * @param pos Map position.
+	 * @return Cluster index.
+	 */
+	int getCluster(Position pos) const
+	{
+		return (pos.y / CLUSTER_SIZE) * _sizeX + pos.x / CLUSTER_SIZE;
+	}
+
+	/**
+	 * Checks if a position is in the corridor found by the last findCorridor().
+	 * @param pos Map position.
+	 * @return True if the position can be used by the path.
+	 */
+	bool isInCorridor(Position pos) const
+	{
+		return _corridor[getCluster(pos)] != 0;
+	}
+
+	/**
+	 * Checks if a cluster is in the corridor found by the last findCorridor().
+	 * @param cluster Cluster index.
+	 * @return True if the cluster can be used by the path.
+	 */
+	bool isCorridorCluster(int cluster) const
+	{
+		return _corridor[cluster] != 0;
+	}
+
+	/// Gets the tile area of a cluster.
+	void getClusterArea(int cluster, Position &from, Position &to) const;
+	/// Gets the number of clusters.
+	int getClusterCount() const;
+	/// Checks if a path is long enough to look for a corridor first.
+	bool isLongPath(Position start, Position end) const;
+	/// Finds the corridor of clusters a path between two positions should follow.
+	bool findCorridor(Pathfinding *pathfinding, BattleUnit *unit, Position start, Position end);
+};
+
+}
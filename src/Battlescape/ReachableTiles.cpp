@@ -0,0 +1,125 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ReachableTiles.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Sets up an empty set of reachable tiles.
+ */
+ReachableTiles::ReachableTiles()
+{
+
+}
+
+/**
+ * Deletes the reachable tiles.
+ */
+ReachableTiles::~ReachableTiles()
+{
+
+}
+
+/**
+ * Clears all reached tiles and prepares the lookup
+ * for a map with the given number of tiles.
+ * @param mapSize Number of tiles on the map.
+ */
+void ReachableTiles::reset(int mapSize)
+{
+	Step unreached = { -1, -1 };
+	if ((int)_steps.size() != mapSize)
+	{
+		_steps.assign(mapSize, unreached);
+	}
+	else
+	{
+		// only the tiles reached by the last search were changed
+		for (std::vector<int>::const_iterator i = _tiles.begin(); i != _tiles.end(); ++i)
+		{
+			_steps[*i] = unreached;
+		}
+	}
+	_tiles.clear();
+}
+
+/**
+ * Adds a tile reached by the search. Tiles are expected
+ * in order of increasing TU cost.
+ * @param tile Index of the reached tile.
+ * @param tuCost TU cost to reach the tile.
+ * @param prevTile Index of the tile it was reached from, -1 for the start.
+ */
+void ReachableTiles::add(int tile, int tuCost, int prevTile)
+{
+	Step step = { tuCost, prevTile };
+	_steps[tile] = step;
+	_tiles.push_back(tile);
+}
+
+/**
+ * Gets the indexes of all reached tiles.
+ * @return Tile indexes, sorted by TU cost.
+ */
+const std::vector<int> &ReachableTiles::getTiles() const
+{
+	return _tiles;
+}
+
+/**
+ * Checks if a tile can be reached.
+ * @param tile Index of the tile.
+ * @return True if the tile was reached.
+ */
+bool ReachableTiles::isReachable(int tile) const
+{
+	return tile >= 0 && tile < (int)_steps.size() && _steps[tile].tuCost != -1;
+}
+
+/**
+ * Gets the lowest TU cost to reach a tile.
+ * @param tile Index of the tile.
+ * @return TU cost, or -1 if the tile can't be reached.
+ */
+int ReachableTiles::getTUCost(int tile) const
+{
+	return isReachable(tile) ? _steps[tile].tuCost : -1;
+}
+
+/**
+ * Gets how many steps the cheapest path to a tile takes.
+ * @param tile Index of the tile.
+ * @return Number of steps, 0 for the start tile or -1 if the tile can't be reached.
+ */
+int ReachableTiles::getStepCount(int tile) const
+{
+	if (!isReachable(tile))
+	{
+		return -1;
+	}
+	int steps = 0;
+	for (int i = tile; _steps[i].prevTile != -1; i = _steps[i].prevTile)
+	{
+		++steps;
+	}
+	return steps;
+}
+
+}
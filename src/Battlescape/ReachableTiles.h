@@ -0,0 +1,62 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+namespace OpenXcom
+{
+
+/**
+ * The tiles a unit can reach with its current time units and energy,
+ * as found by Pathfinding::findReachable(). Keeps the TU cost and the
+ * previous step of every reached tile, indexed by tile index, so the
+ * AI can look up costs and step counts without searching again.
+ * The lookup is kept between searches and only the reached tiles
+ * get cleared, so reuse the same object for every search.
+ */
+class ReachableTiles
+{
+private:
+	struct Step
+	{
+		int tuCost;
+		int prevTile;
+	};
+	std::vector<Step> _steps;
+	std::vector<int> _tiles;
+public:
+	/// Creates an empty set of reachable tiles.
+	ReachableTiles();
+	/// Cleans up the reachable tiles.
+	~ReachableTiles();
+	/// Clears the tiles and sizes the lookup for a map.
+	void reset(int mapSize);
+	/// Adds a reached tile.
+	void add(int tile, int tuCost, int prevTile);
+	/// Gets the indexes of the reached tiles, cheapest first.
+	const std::vector<int> &getTiles() const;
+	/// Checks if a tile was reached.
+	bool isReachable(int tile) const;
+	/// Gets the TU cost to reach a tile.
+	int getTUCost(int tile) const;
+	/// Gets the number of steps to reach a tile.
+	int getStepCount(int tile) const;
+};
+
+}
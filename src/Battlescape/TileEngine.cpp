@@ -33,6 +33,7 @@
 #include "../Savegame/BattleUnitStatistics.h"
 #include "../Engine/RNG.h"
 #include "../Engine/GraphSubset.h"
+#include "../Engine/Profiler.h"
 #include "BattlescapeState.h"
 #include "../Mod/MapDataSet.h"
 #include "../Mod/Unit.h"
@@ -192,6 +193,38 @@ void iterateTiles(SavedBattleGame* save, GraphSubset gs, TileFunc func)
 	}
 }
 
+/**
+ * Apply func to the frequently used data of each tile in a square subset of the map.
+ * Streams through the dense hot data array instead of the tiles themselves.
+ * @param save Map data.
+ * @param gs Square subset of map area.
+ * @param func Call back, gets the tile data and its position.
+ */
+template<typename HotFunc>
+void iterateTileHotData(SavedBattleGame* save, GraphSubset gs, HotFunc func)
+{
+	const auto totalSizeX = save->getMapSizeX();
+	const auto totalSizeY = save->getMapSizeY();
+	const auto totalSizeZ = save->getMapSizeZ();
+
+	gs = GraphSubset::intersection(gs, GraphSubset{ totalSizeX, totalSizeY });
+	if (gs.size_x() && gs.size_y())
+	{
+		for (int z = 0; z < totalSizeZ; ++z)
+		{
+			auto rowStart = save->getTileHotData(save->getTileIndex(Position{ gs.beg_x, gs.beg_y, z }));
+			for (int y = gs.beg_y; y != gs.end_y; ++y, rowStart += totalSizeX)
+			{
+				auto curr = rowStart;
+				for (int x = gs.beg_x; x != gs.end_x; ++x, curr += 1)
+				{
+					func(curr, Position{ x, y, z });
+				}
+			}
+		}
+	}
+}
+
 /**
  * Generate square subset of map using position and radius.
  * @param position Starting position.
@@ -208,6 +241,9 @@ GraphSubset mapAreaExpand(GraphSubset gs, int radius)
 	return { std::make_pair(gs.beg_x - radius, gs.end_x + radius), std::make_pair(gs.beg_y - radius, gs.end_y + radius) };
 }
 
+/// Number of terrain change areas kept for caches that only update what changed.
+constexpr int terrainChangeHistory = 16;
+
 } // namespace
 
 const int TileEngine::heightFromCenter[11] = {0,-2,+2,-4,+4,-6,+6,-8,+8,-12,+12};
@@ -223,7 +259,7 @@ constexpr Position TileEngine::invalid;
  * @param maxDarknessToSeeUnits Threshold of darkness for LoS calculation.
  */
 TileEngine::TileEngine(SavedBattleGame *save, Mod *mod) :
-	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventory("STR_GROUND", true)), _personalLighting(true), _cacheTile(0), _cacheTileBelow(0),
+	_save(save), _voxelData(mod->getVoxelData()), _inventorySlotGround(mod->getInventory("STR_GROUND", true)), _personalLighting(true), _cacheTile(0), _cacheTileBelow(0), _spotterCacheState(0), _terrainChanges(0), _lightingChanges(0), _terrainChangeAreas(terrainChangeHistory, GraphSubset(0, 0)), _visibilityIndexState(0), _influence(save, 20),
 	_maxViewDistance(mod->getMaxViewDistance()), _maxViewDistanceSq(_maxViewDistance * _maxViewDistance),
 	_maxVoxelViewDistance(_maxViewDistance * 16), _maxDarknessToSeeUnits(mod->getMaxDarknessToSeeUnits()),
 	_maxStaticLightDistance(mod->getMaxStaticLightDistance()), _maxDynamicLightDistance(mod->getMaxDynamicLightDistance()),
@@ -398,6 +434,7 @@ void TileEngine::calculateUnitLighting(GraphSubset gs)
 
 void TileEngine::calculateLighting(LightLayers layer, Position position, int eventRadius, bool terrianChanged)
 {
+	Profiler profile(Profiler::PROFILE_LIGHTING);
 	auto gsDynamic = GraphSubset{ _save->getMapSizeX(), _save->getMapSizeY() };
 	auto gsStatic = gsDynamic;
 
@@ -407,11 +444,14 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 		gsStatic = mapArea(position, eventRadius + getMaxStaticLightDistance());
 	}
 
+	++_lightingChanges;
 	if (terrianChanged)
 	{
+		auto gsTerrain = mapArea(position, position != invalid ? eventRadius + 1 : 1000);
+		addTerrainChange(gsTerrain);
 		iterateTiles(
 			_save,
-			mapArea(position, position != invalid ? eventRadius + 1 : 1000),
+			gsTerrain,
 			[&](Tile* tile)
 			{
 				const auto currPos = tile->getPosition();
@@ -463,28 +503,38 @@ void TileEngine::calculateLighting(LightLayers layer, Position position, int eve
 						cache.blockDirDown |= (1 << dir);
 					}
 				}
+
+				int cover = 0;
+				for (int dir = 0; dir < 8; ++dir)
+				{
+					if (cache.blockDir & (1 << dir))
+					{
+						++cover;
+					}
+				}
+				_influence.setCover(currPos, cover);
 			}
 		);
 	}
 
 	if (layer <= LL_FIRE)
 	{
-		iterateTiles(
+		iterateTileHotData(
 			_save,
 			gsStatic,
-			[&](Tile* tile)
+			[&](TileHotData* hot, Position)
 			{
-				tile->resetLightMulti(layer);
+				hot->resetLightMulti(layer);
 			}
 		);
 	}
 
-	iterateTiles(
+	iterateTileHotData(
 		_save,
 		gsDynamic,
-		[&](Tile* tile)
+		[&](TileHotData* hot, Position)
 		{
-			tile->resetLightMulti(std::max(layer, LL_ITEMS));
+			hot->resetLightMulti(std::max(layer, LL_ITEMS));
 		}
 	);
 
@@ -520,15 +570,14 @@ void TileEngine::addLight(GraphSubset gs, Position center, int power, LightLayer
 	const auto topVoxel = (_blockVisibility[_save->getTileIndex(center)].blockUp ? (center.z + 1) : _save->getMapSizeZ()) * accuracy.z - 1;
 	const auto maxFirePower = std::min(15, getMaxStaticLightDistance() - 1);
 
-	iterateTiles(
+	iterateTileHotData(
 		_save,
 		GraphSubset::intersection(gs, mapArea(center, power - 1)),
-		[&](Tile* tile)
+		[&](TileHotData* hot, Position target)
 		{
-			const auto target = tile->getPosition();
 			const auto diff = target - center;
 			const auto distance = (int)Round(sqrt(distanceSq(target, center, true)));
-			const auto targetLight = tile->getLightMulti(layer);
+			const auto targetLight = hot->getLightMulti(layer);
 			auto currLight = power - distance;
 
 			if (currLight <= targetLight)
@@ -537,7 +586,7 @@ void TileEngine::addLight(GraphSubset gs, Position center, int power, LightLayer
 			}
 			if (clasicLighting)
 			{
-				tile->addLight(currLight, layer);
+				hot->addLight(currLight, layer);
 				return;
 			}
 
@@ -658,7 +707,7 @@ void TileEngine::addLight(GraphSubset gs, Position center, int power, LightLayer
 			currLight = (lightA + lightB) / 2;
 			if (currLight > targetLight)
 			{
-				tile->addLight(currLight, layer);
+				hot->addLight(currLight, layer);
 			}
 		}
 	);
@@ -769,7 +818,7 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 							//Unit within arc, but not in view sector. If it just walked out we need to remove it.
 							unit->removeFromVisibleUnits((*i));
 						}
-						else if (visible(unit, _save->getTile(posToCheck))) // (distance is checked here)
+						else if (visibleIndexed(unit, _save->getTile(posToCheck), false)) // (distance is checked here)
 						{
 							//Unit (or part thereof) visible to one or more eyes of this unit.
 							if (unit->getFaction() == FACTION_PLAYER)
@@ -781,7 +830,7 @@ bool TileEngine::calculateUnitsInFOV(BattleUnit* unit, const Position eventPos,
 								&& !unit->hasVisibleUnit((*i)))
 							{
 								unit->addToVisibleUnits((*i));
-								unit->addToVisibleTiles((*i)->getTile());
+								unit->addToVisibleTiles((*i)->getTile(), _save->getTileIndex((*i)->getTile()->getPosition()));
 
 								if (unit->getFaction() == FACTION_HOSTILE && (*i)->getFaction() != FACTION_HOSTILE)
 								{
@@ -919,9 +968,10 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 										Position posVisited = (*i);
 										//Add tiles to the visible list only once. BUT we still need to calculate the whole trajectory as
 										// this bresenham line's period might be different from the one that originally revealed the tile.
-										if (!unit->hasVisibleTile(_save->getTile(posVisited)))
+										int indexVisited = _save->getTileIndex(posVisited);
+										if (!unit->hasVisibleTile(indexVisited))
 										{
-											unit->addToVisibleTiles(_save->getTile(posVisited));
+											unit->addToVisibleTiles(_save->getTile(posVisited), indexVisited);
 											_save->getTile(posVisited)->setVisible(+1);
 											_save->getTile(posVisited)->setDiscovered(true, 2);
 
@@ -951,6 +1001,8 @@ void TileEngine::calculateTilesInFOV(BattleUnit *unit, const Position eventPos,
 */
 bool TileEngine::calculateFOV(BattleUnit *unit, bool doTileRecalc, bool doUnitRecalc)
 {
+	Profiler profile(Profiler::PROFILE_FOV);
+	validateVisibilityIndex();
 	//Force a full FOV recheck for this unit.
 	if (doTileRecalc) calculateTilesInFOV(unit);
 	return doUnitRecalc ? calculateUnitsInFOV(unit) : false;
@@ -1249,6 +1301,155 @@ bool TileEngine::canTargetUnit(Position *originVoxel, Tile *tile, Position *scan
 	return false;
 }
 
+/**
+ * Checks for another unit available for targeting, like canTargetUnit(),
+ * but remembers the answer. The AI asks the same questions for many
+ * candidate tiles and many of its units, so the results are shared until
+ * validateSpotterCache() finds that units moved or terrain changed.
+ * @param originVoxel Voxel of trace origin (eye or gun's barrel).
+ * @param tile The tile to check for.
+ * @param excludeUnit is self (not to hit self).
+ * @param potentialUnit is a hypothetical unit to draw a virtual line of fire for AI.
+ * @return True if the unit can be targetted.
+ */
+bool TileEngine::canTargetUnitCached(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *potentialUnit)
+{
+	SpotterCacheKey key = { *originVoxel, _save->getTileIndex(tile->getPosition()), excludeUnit ? excludeUnit->getId() : -1, potentialUnit ? potentialUnit->getId() : -1 };
+	std::unordered_map<SpotterCacheKey, bool, SpotterCacheHash>::const_iterator i = _spotterCache.find(key);
+	if (i != _spotterCache.end())
+	{
+		return i->second;
+	}
+	Position scanVoxel;
+	bool result = canTargetUnit(originVoxel, tile, &scanVoxel, excludeUnit, potentialUnit);
+	_spotterCache[key] = result;
+	return result;
+}
+
+/**
+ * Drops the results of canTargetUnitCached() when they might be stale:
+ * on a new turn, when another faction moves, when terrain changed or
+ * when any unit has moved, changed height or fallen since they were stored.
+ */
+void TileEngine::validateSpotterCache()
+{
+	Uint64 state = getBattleStateChecksum();
+	if (state != _spotterCacheState)
+	{
+		_spotterCache.clear();
+		_spotterCacheState = state;
+	}
+}
+
+/**
+ * Drops the visibility results remembered by visibleIndexed() when they
+ * might be stale: besides everything getBattleStateChecksum() covers,
+ * visibility depends on lighting, smoke and fire (each change of them
+ * goes through calculateLighting()) and on the health, stun and fire of
+ * units, which visibility scripts can look at.
+ */
+void TileEngine::validateVisibilityIndex()
+{
+	Uint64 state = (getBattleStateChecksum() ^ (Uint32)_lightingChanges) * 1099511628211ULL;
+	for (std::vector<BattleUnit*>::const_iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		int unitValues[3] = { (*i)->getHealth(), (*i)->getStunlevel(), (*i)->getFire() };
+		for (int n = 0; n < 3; ++n)
+		{
+			state = (state ^ (Uint32)unitValues[n]) * 1099511628211ULL;
+		}
+	}
+	if (state != _visibilityIndexState)
+	{
+		_visibilityIndex.clear();
+		_visibilityIndexState = state;
+	}
+}
+
+/**
+ * Checks for an opposing unit on this tile, like visible(), remembering
+ * the result per watcher and tile. The FOV updates that follow every
+ * step fill the index, so reaction fire checks right after usually know
+ * who can see the moving unit without tracing a single ray.
+ * The caller must call validateVisibilityIndex() first.
+ * @param currentUnit The watcher.
+ * @param tile The tile to check for.
+ * @param reuse Use a remembered result if there is one, otherwise always recalculate it.
+ * @return True if visible.
+ */
+bool TileEngine::visibleIndexed(BattleUnit *currentUnit, Tile *tile, bool reuse)
+{
+	if (!tile || !tile->getUnit())
+	{
+		return false;
+	}
+	Uint64 key = ((Uint64)(Uint32)currentUnit->getId() << 32) | (Uint32)_save->getTileIndex(tile->getPosition());
+	if (reuse)
+	{
+		std::unordered_map<Uint64, bool>::const_iterator i = _visibilityIndex.find(key);
+		if (i != _visibilityIndex.end())
+		{
+			return i->second;
+		}
+	}
+	bool result = visible(currentUnit, tile);
+	_visibilityIndex[key] = result;
+	return result;
+}
+
+/**
+ * Counts a terrain change and remembers the map area it touched.
+ * @param area Map area of the change.
+ */
+void TileEngine::addTerrainChange(GraphSubset area)
+{
+	++_terrainChanges;
+	_terrainChangeAreas[_terrainChanges % terrainChangeHistory] = area;
+}
+
+/**
+ * Gets the map area one of the last terrain changes touched,
+ * so data derived from terrain can update only that area.
+ * @param change Number of the change, from 1 to getTerrainChanges().
+ * @param area Map area of the change.
+ * @return False if the change is too old to be remembered.
+ */
+bool TileEngine::getTerrainChangeArea(int change, GraphSubset &area) const
+{
+	if (change <= 0 || change > _terrainChanges || change <= _terrainChanges - terrainChangeHistory)
+	{
+		return false;
+	}
+	area = _terrainChangeAreas[change % terrainChangeHistory];
+	return true;
+}
+
+/**
+ * Gets a checksum of everything lines of fire and movement depend on:
+ * the turn, the side to move, terrain changes and the position, height
+ * and state of every unit. Used to tell if cached results are still valid.
+ * @return Checksum of the battle state.
+ */
+Uint64 TileEngine::getBattleStateChecksum() const
+{
+	Uint64 state = 14695981039346656037ULL;
+	int values[3] = { _save->getTurn(), (int)_save->getSide(), _terrainChanges };
+	for (int n = 0; n < 3; ++n)
+	{
+		state = (state ^ (Uint32)values[n]) * 1099511628211ULL;
+	}
+	for (std::vector<BattleUnit*>::const_iterator i = _save->getUnits()->begin(); i != _save->getUnits()->end(); ++i)
+	{
+		Position pos = (*i)->getPosition();
+		int unitValues[7] = { (*i)->getId(), pos.x, pos.y, pos.z, (*i)->isOut(), (*i)->getHeight(), (*i)->getFloatHeight() };
+		for (int n = 0; n < 7; ++n)
+		{
+			state = (state ^ (Uint32)unitValues[n]) * 1099511628211ULL;
+		}
+	}
+	return state;
+}
+
 /**
  * Checks for a tile part available for targeting and what particular voxel.
  * @param originVoxel Voxel of trace origin (gun's barrel).
@@ -1392,6 +1593,8 @@ bool TileEngine::canTargetTile(Position *originVoxel, Tile *tile, int part, Posi
  */
 void TileEngine::calculateFOV(Position position, int eventRadius, const bool updateTiles, const bool appendToTileVisibility)
 {
+	Profiler profile(Profiler::PROFILE_FOV);
+	validateVisibilityIndex();
 	int updateRadius;
 	if (eventRadius == -1)
 	{
@@ -1430,6 +1633,7 @@ void TileEngine::calculateFOV(Position position, int eventRadius, const bool upd
  */
 bool TileEngine::checkReactionFire(BattleUnit *unit, const BattleAction &originalAction)
 {
+	Profiler profile(Profiler::PROFILE_REACTION_FIRE);
 	// reaction fire only triggered when the actioning unit is of the currently playing side, and is still on the map (alive)
 	if (unit->getFaction() != _save->getSide() || unit->getTile() == 0)
 	{
@@ -1483,6 +1687,7 @@ std::vector<TileEngine::ReactionScore> TileEngine::getSpottingUnits(BattleUnit*
 	std::vector<TileEngine::ReactionScore> spotters;
 	Tile *tile = unit->getTile();
 	int threshold = unit->getReactionScore();
+	validateVisibilityIndex();
 	// no reaction on civilian turn.
 	if (_save->getSide() != FACTION_NEUTRAL)
 	{
@@ -1528,10 +1733,10 @@ std::vector<TileEngine::ReactionScore> TileEngine::getSpottingUnits(BattleUnit*
 
 					// can actually see the target Tile, or we got hit
 				if (((*i)->checkViewSector(unit->getPosition()) || gotHit) &&
+					// can actually see the unit, usually known from the FOV update of this step
+					visibleIndexed(*i, tile, true) &&
 					// can actually target the unit
-					canTargetUnit(&originVoxel, tile, &targetVoxel, *i) &&
-					// can actually see the unit
-					visible(*i, tile))
+					canTargetUnit(&originVoxel, tile, &targetVoxel, *i))
 				{
 					if ((*i)->getFaction() == FACTION_PLAYER)
 					{
@@ -3006,11 +3211,13 @@ int TileEngine::unitOpensDoor(BattleUnit *unit, bool rClick, int dir)
 
 	if (door == 0 || door == 1)
 	{
+		// the door is already open, even if the unit can't pay for it below,
+		// so the terrain change has to be counted for the caches built on it
+		calculateLighting(LL_FIRE, doorCentre, doorsOpened, true);
 		if (_save->getBattleGame()->checkReservedTU(unit, TUCost, 0))
 		{
 			if (unit->spendTimeUnits(TUCost))
 			{
-				calculateLighting(LL_FIRE, doorCentre, doorsOpened, true);
 				// Update FOV through the doorway.
 				calculateFOV(doorCentre, doorsOpened, true, true);
 			}
@@ -3076,6 +3283,7 @@ std::pair<int, Position> TileEngine::checkAdjacentDoors(Position pos, TilePart p
 int TileEngine::closeUfoDoors()
 {
 	int doorsclosed = 0;
+	Position closedFrom, closedTo;
 
 	// prepare a list of tiles on fire/smoke & close any ufo doors
 	for (int i = 0; i < _save->getMapSizeXYZ(); ++i)
@@ -3092,7 +3300,25 @@ int TileEngine::closeUfoDoors()
 				continue;
 			}
 		}
-		doorsclosed += _save->getTile(i)->closeUfoDoor();
+		if (_save->getTile(i)->closeUfoDoor())
+		{
+			Position pos = _save->getTile(i)->getPosition();
+			if (doorsclosed == 0)
+			{
+				closedFrom = closedTo = pos;
+			}
+			closedFrom = Position(std::min(closedFrom.x, pos.x), std::min(closedFrom.y, pos.y), 0);
+			closedTo = Position(std::max(closedTo.x, pos.x), std::max(closedTo.y, pos.y), 0);
+			++doorsclosed;
+		}
+	}
+
+	if (doorsclosed > 0)
+	{
+		// closed doors block sight and movement again
+		Position centre = Position((closedFrom.x + closedTo.x) / 2, (closedFrom.y + closedTo.y) / 2, 0);
+		int radius = std::max(closedTo.x - closedFrom.x, closedTo.y - closedFrom.y) / 2 + 1;
+		calculateLighting(LL_FIRE, centre, radius, true);
 	}
 
 	return doorsclosed;
@@ -4046,6 +4272,7 @@ bool TileEngine::validateThrow(BattleAction &action, Position originVoxel, Posit
  */
 void TileEngine::recalculateFOV()
 {
+	Profiler profile(Profiler::PROFILE_FOV);
 	for (std::vector<BattleUnit*>::iterator bu = _save->getUnits()->begin(); bu != _save->getUnits()->end(); ++bu)
 	{
 		if ((*bu)->getTile() != 0)
@@ -4195,6 +4422,7 @@ void TileEngine::setDangerZone(Position pos, int radius, BattleUnit *unit)
 	{
 		return;
 	}
+	_influence.addDanger(pos, radius);
 	// set the epicenter as dangerous
 	tile->setDangerous(true);
 	Position originVoxel = (pos * Position(16,16,24)) + Position(8,8,12 + -tile->getTerrainLevel());
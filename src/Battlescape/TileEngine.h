@@ -18,10 +18,13 @@
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <vector>
+#include <unordered_map>
 #include "Position.h"
+#include "InfluenceMap.h"
 #include "BattlescapeGame.h"
 #include "../Mod/RuleItem.h"
 #include "../Mod/MapData.h"
+#include "../Engine/GraphSubset.h"
 #include <SDL.h>
 
 namespace OpenXcom
@@ -32,7 +35,6 @@ class BattleUnit;
 class BattleItem;
 class Tile;
 struct BattleAction;
-struct GraphSubset;
 
 enum BattleActionType : Uint8;
 enum LightLayers : Uint8;
@@ -67,6 +69,35 @@ private:
 		Uint8 smoke: 1;
 		Uint8 fire: 1;
 	};
+	/**
+	 * Helper class identifying a cached canTargetUnit() check.
+	 */
+	struct SpotterCacheKey
+	{
+		Position origin;
+		int tile;
+		int excludeUnit;
+		int potentialUnit;
+
+		bool operator==(const SpotterCacheKey &other) const
+		{
+			return origin == other.origin && tile == other.tile && excludeUnit == other.excludeUnit && potentialUnit == other.potentialUnit;
+		}
+	};
+	/**
+	 * Hash of SpotterCacheKey.
+	 */
+	struct SpotterCacheHash
+	{
+		size_t operator()(const SpotterCacheKey &key) const
+		{
+			size_t h = key.tile;
+			h = h * 31 + ((key.origin.x << 20) ^ (key.origin.y << 8) ^ key.origin.z);
+			h = h * 31 + key.excludeUnit;
+			h = h * 31 + key.potentialUnit;
+			return h;
+		}
+	};
 	/**
 	 * Helper class storing reaction data.
 	 */
@@ -87,6 +118,14 @@ private:
 	Tile *_cacheTile;
 	Tile *_cacheTileBelow;
 	Position _cacheTilePos;
+	std::unordered_map<SpotterCacheKey, bool, SpotterCacheHash> _spotterCache;
+	Uint64 _spotterCacheState;
+	int _terrainChanges, _lightingChanges;
+	/// Map areas of the last terrain changes, by change number.
+	std::vector<GraphSubset> _terrainChangeAreas;
+	std::unordered_map<Uint64, bool> _visibilityIndex;
+	Uint64 _visibilityIndexState;
+	InfluenceMap _influence;
 	const int _maxViewDistance;        // 20 tiles by default
 	const int _maxViewDistanceSq;      // 20 * 20
 	const int _maxVoxelViewDistance;   // maxViewDistance * 16
@@ -129,6 +168,10 @@ private:
 
 	/// Checks validity of a snap shot to this position.
 	ReactionScore determineReactionType(BattleUnit *unit, BattleUnit *target);
+	/// Drops remembered visibility results that the battle state changed.
+	void validateVisibilityIndex();
+	/// Checks visibility like visible(), using the visibility index.
+	bool visibleIndexed(BattleUnit *currentUnit, Tile *tile, bool reuse);
 	/// Creates a vector of units that can spot this unit.
 	std::vector<ReactionScore> getSpottingUnits(BattleUnit* unit);
 	/// Given a vector of spotters, and a unit, picks the spotter with the highest reaction score.
@@ -221,6 +264,20 @@ public:
 	int checkVoxelExposure(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *excludeAllBut);
 	/// Checks validity for targetting a unit.
 	bool canTargetUnit(Position *originVoxel, Tile *tile, Position *scanVoxel, BattleUnit *excludeUnit, BattleUnit *potentialUnit = 0);
+	/// Counts a terrain change in an area of the map.
+	void addTerrainChange(GraphSubset area);
+	/// Checks validity for targetting a unit, reusing earlier results.
+	bool canTargetUnitCached(Position *originVoxel, Tile *tile, BattleUnit *excludeUnit, BattleUnit *potentialUnit = 0);
+	/// Drops cached targetting results that units or the turn changed.
+	void validateSpotterCache();
+	/// Gets a checksum of the unit and terrain state.
+	Uint64 getBattleStateChecksum() const;
+	/// Gets the AI's map of which units threaten which tiles.
+	InfluenceMap *getInfluenceMap() { return &_influence; }
+	/// Gets the number of terrain changes so far, to tell if data derived from terrain is stale.
+	int getTerrainChanges() const { return _terrainChanges; }
+	/// Gets the map area one of the last terrain changes touched.
+	bool getTerrainChangeArea(int change, GraphSubset &area) const;
 	/// Check validity for targetting a tile.
 	bool canTargetTile(Position *originVoxel, Tile *tile, int part, Position *scanVoxel, BattleUnit *excludeUnit);
 	/// Calculates the z voxel for shadows.
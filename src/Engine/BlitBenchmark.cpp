@@ -0,0 +1,227 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "BlitBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include "Game.h"
+#include "Options.h"
+#include "Logger.h"
+#include "FileMap.h"
+#include "Surface.h"
+#include "SurfaceSet.h"
+#include "ShaderDraw.h"
+#include "ShaderMove.h"
+#include "ShaderDrawSimd.h"
+#include "../Mod/Mod.h"
+#include "../Mod/RuleTerrain.h"
+#include "../Mod/MapDataSet.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Adds every frame of a sprite set to a list.
+ * @param set Sprite set, can be null.
+ * @param frames List of frames.
+ */
+void addFrames(SurfaceSet *set, std::vector<Surface*> &frames)
+{
+	if (set == 0)
+	{
+		return;
+	}
+	for (size_t i = 0; i < set->getTotalFrames(); ++i)
+	{
+		Surface *frame = set->getFrame(i);
+		if (frame != 0)
+		{
+			frames.push_back(frame);
+		}
+	}
+}
+
+}
+
+/// Shade 0 is the plain transparent copy, battlescape shades go up to 15.
+const BlitBenchmark::Case BlitBenchmark::CASES[BlitBenchmark::CASE_COUNT] =
+{
+	{ "copy", 0, false, 0 },
+	{ "shade", 7, false, 0 },
+	{ "recolor", 7, false, 5 },
+	{ "half", 7, true, 0 },
+};
+
+/**
+ * Sets up a benchmark.
+ * @param game Pointer to the core game.
+ */
+BlitBenchmark::BlitBenchmark(Game *game) : _game(game)
+{
+}
+
+/**
+ *
+ */
+BlitBenchmark::~BlitBenchmark()
+{
+}
+
+/**
+ * Gathers the frames of every sprite set in the UNITS folder, and of every terrain set
+ * the mods use, loading the terrain sets that aren't loaded yet.
+ */
+void BlitBenchmark::collectFrames()
+{
+	Mod *mod = _game->getMod();
+	std::set<std::string> usets = FileMap::filterFiles(FileMap::getVFolderContents("UNITS"), "PCK");
+	for (std::set<std::string>::const_iterator i = usets.begin(); i != usets.end(); ++i)
+	{
+		std::string name = *i;
+		std::transform(name.begin(), name.end(), name.begin(), toupper);
+		addFrames(mod->getSurfaceSet(name, false), _unitFrames);
+	}
+
+	std::set<MapDataSet*> terrainSets;
+	const std::vector<std::string> &terrains = mod->getTerrainList();
+	for (std::vector<std::string>::const_iterator i = terrains.begin(); i != terrains.end(); ++i)
+	{
+		std::vector<MapDataSet*> *sets = mod->getTerrain(*i)->getMapDataSets();
+		terrainSets.insert(sets->begin(), sets->end());
+	}
+	for (std::set<MapDataSet*>::const_iterator i = terrainSets.begin(); i != terrainSets.end(); ++i)
+	{
+		(*i)->loadData();
+		addFrames((*i)->getSurfaceset(), _terrainFrames);
+	}
+}
+
+/**
+ * Blits a list of frames all over a surface a number of times, moving
+ * each one a bit so some end up clipped by the edges, like on the map.
+ * @param frames Frames to blit.
+ * @param blit Kind of blit.
+ * @param rows True to use Surface::blitNShade(), false to use the per-pixel helpers.
+ * @param rounds Number of times to blit every frame.
+ * @param dest Surface to blit on.
+ * @return Seconds taken.
+ */
+double BlitBenchmark::blitFrames(const std::vector<Surface*> &frames, const Case &blit, bool rows, int rounds, Surface *dest) const
+{
+	Clock::time_point start = Clock::now();
+	dest->lock();
+	int n = 0;
+	for (int round = 0; round < rounds; ++round)
+	{
+		for (std::vector<Surface*>::const_iterator i = frames.begin(); i != frames.end(); ++i, ++n)
+		{
+			int x = (n * 37) % (dest->getWidth() + 32) - 16;
+			int y = (n * 23) % (dest->getHeight() + 40) - 20;
+			if (rows)
+			{
+				(*i)->blitNShade(dest, x, y, blit.shade, blit.half, blit.newBaseColor);
+				continue;
+			}
+			ShaderMove<Uint8> src(*i, x, y);
+			if (blit.half)
+			{
+				GraphSubset g = src.getDomain();
+				g.beg_x = g.end_x/2;
+				src.setDomain(g);
+			}
+			if (blit.newBaseColor)
+			{
+				ShaderDraw<helper::ColorReplace>(ShaderSurface(dest), src, ShaderScalar(blit.shade), ShaderScalar((blit.newBaseColor - 1) << 4));
+			}
+			else
+			{
+				ShaderDraw<helper::StandardShade>(ShaderSurface(dest), src, ShaderScalar(blit.shade));
+			}
+		}
+	}
+	dest->unlock();
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * Loads the mods and blits every unit and terrain frame a number of
+ * times in each case, then reports the times taken.
+ * @param rounds Number of times to blit every frame in each case.
+ * @return Program exit code.
+ */
+int BlitBenchmark::run(int rounds)
+{
+	try
+	{
+		Log(LOG_INFO) << "Loading data...";
+		Options::updateMods();
+		_game->loadMods();
+		collectFrames();
+	}
+	catch (std::exception &e)
+	{
+		Log(LOG_ERROR) << e.what();
+		return EXIT_FAILURE;
+	}
+	if (_unitFrames.empty() && _terrainFrames.empty())
+	{
+		Log(LOG_ERROR) << "No unit or terrain frames to blit.";
+		return EXIT_FAILURE;
+	}
+
+	// a battlescape view at the original resolution
+	Surface dest(Options::baseXBattlescape, Options::baseYBattlescape);
+	const char *rowName = helper::ShadeRow::get().name;
+	const std::vector<Surface*> *frameLists[2] = { &_unitFrames, &_terrainFrames };
+	const char *listNames[2] = { "units", "terrain" };
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "Blitted " << _unitFrames.size() << " unit and " << _terrainFrames.size() << " terrain frames " << rounds << " times, rows use " << rowName << std::endl;
+	ss << std::endl;
+	ss << std::setw(10) << "Frames" << std::setw(10) << "Blit" << std::setw(14) << "Rows ms" << std::setw(14) << "Pixels ms" << std::setw(10) << "Speedup" << std::endl;
+	for (int list = 0; list < 2; ++list)
+	{
+		if (frameLists[list]->empty())
+		{
+			continue;
+		}
+		for (int c = 0; c < CASE_COUNT; ++c)
+		{
+			double rowTime = blitFrames(*frameLists[list], CASES[c], true, rounds, &dest);
+			double pixelTime = blitFrames(*frameLists[list], CASES[c], false, rounds, &dest);
+			ss << std::setw(10) << listNames[list] << std::setw(10) << CASES[c].name;
+			ss << std::setw(14) << rowTime * 1000 << std::setw(14) << pixelTime * 1000;
+			ss << std::setw(10) << (rowTime > 0.0 ? pixelTime / rowTime : 0.0) << std::endl;
+		}
+	}
+	std::cout << ss.str();
+	return EXIT_SUCCESS;
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+
+namespace OpenXcom
+{
+
+class Game;
+class Surface;
+
+/**
+ * Blits the unit and terrain sprites of the loaded mods without a window,
+ * to measure the shaded blits the battlescape is drawn with. Every case
+ * is timed through Surface::blitNShade(), which uses the row functions
+ * picked for this CPU, and through the per-pixel ShaderDraw helpers it
+ * falls back to, then the times of both get reported.
+ */
+class BlitBenchmark
+{
+private:
+	/**
+	 * Kind of blit to time.
+	 */
+	struct Case
+	{
+		const char *name;
+		int shade;
+		bool half;
+		int newBaseColor;
+	};
+	static const int CASE_COUNT = 4;
+	static const Case CASES[CASE_COUNT];
+
+	Game *_game;
+	std::vector<Surface*> _unitFrames, _terrainFrames;
+
+	/// Gathers the frames to blit.
+	void collectFrames();
+	/// Blits a list of frames a number of times.
+	double blitFrames(const std::vector<Surface*> &frames, const Case &blit, bool rows, int rounds, Surface *dest) const;
+public:
+	/// Creates a benchmark for a game.
+	BlitBenchmark(Game *game);
+	/// Cleans up the benchmark.
+	~BlitBenchmark();
+	/// Blits every frame a number of times in each case.
+	int run(int rounds);
+};
+
+}
@@ -74,7 +74,10 @@ void create()
 #endif
 
 	_info.push_back(OptionInfo("maxFrameSkip", &maxFrameSkip, 0));
+	_info.push_back(OptionInfo("renderThreads", &renderThreads, 0)); // extra threads drawing the battlescape and scaling the screen, 0 = main thread only
 	_info.push_back(OptionInfo("traceAI", &traceAI, false));
+	_info.push_back(OptionInfo("speculativeAI", &speculativeAI, false)); // find where the next AI unit can move on a worker thread while the current one thinks
+	_info.push_back(OptionInfo("bufferedFireSpread", &bufferedFireSpread, false)); // spread fire and smoke with order-independent steps split across the render threads, plays out differently from the original
 	_info.push_back(OptionInfo("verboseLogging", &verboseLogging, false));
 	_info.push_back(OptionInfo("StereoSound", &StereoSound, true));
 	//_info.push_back(OptionInfo("baseXResolution", &baseXResolution, Screen::ORIGINAL_WIDTH));
@@ -132,6 +135,7 @@ void create()
 	_info.push_back(OptionInfo("cursorInBlackBandsInBorderlessWindow", &cursorInBlackBandsInBorderlessWindow, false));
 	_info.push_back(OptionInfo("saveOrder", (int*)&saveOrder, SORT_DATE_DESC));
 	_info.push_back(OptionInfo("geoClockSpeed", &geoClockSpeed, 80));
+	_info.push_back(OptionInfo("geoLookupResolution", &geoLookupResolution, 1)); // cells per degree of the region and country lookup rasters
 	_info.push_back(OptionInfo("dogfightSpeed", &dogfightSpeed, 30));
 	_info.push_back(OptionInfo("geoScrollSpeed", &geoScrollSpeed, 20));
 	_info.push_back(OptionInfo("geoDragScrollButton", &geoDragScrollButton, SDL_BUTTON_MIDDLE));
@@ -411,6 +415,20 @@ bool showHelp(int argc, char *argv[])
 	help << "        use PATH as the default User Folder instead of auto-detecting" << std::endl << std::endl;
 	help << "-cfg PATH  or  -config PATH" << std::endl;
 	help << "        use PATH as the default Config Folder instead of auto-detecting" << std::endl << std::endl;
+	help << "-benchmark SAVE" << std::endl;
+	help << "        run the Geoscape of SAVE without a window or player and report how long it took" << std::endl << std::endl;
+	help << "-benchmarkDays DAYS" << std::endl;
+	help << "        number of game days to run with -benchmark (default 30)" << std::endl << std::endl;
+	help << "-battleBenchmark MISSION" << std::endl;
+	help << "        fight a new battle of MISSION without a window or player and report how long each turn took" << std::endl << std::endl;
+	help << "-battleTerrain TERRAIN" << std::endl;
+	help << "        terrain to fight on with -battleBenchmark (default the first one that fits)" << std::endl << std::endl;
+	help << "-battleSeed SEED" << std::endl;
+	help << "        random seed for -battleBenchmark, any number picks its own battle (default 0)" << std::endl << std::endl;
+	help << "-battleTurns TURNS" << std::endl;
+	help << "        number of turns to fight with -battleBenchmark (default 20)" << std::endl << std::endl;
+	help << "-blitBenchmark ROUNDS" << std::endl;
+	help << "        blit every unit and terrain frame ROUNDS times without a window and report how long it took (eg. 100)" << std::endl << std::endl;
 	help << "-KEY VALUE" << std::endl;
 	help << "        set option KEY to VALUE instead of default/loaded value (eg. -displayWidth 640)" << std::endl << std::endl;
 	help << "-help" << std::endl;
@@ -1121,6 +1139,24 @@ const std::vector<OptionInfo> &getOptionInfo()
 	return _info;
 }
 
+/**
+ * Returns the value given on the command line to an
+ * argument that isn't an option, like "-benchmark".
+ * @param name Argument name, without the dash.
+ * @return Argument value, or empty if it wasn't given.
+ */
+std::string getCommandLine(const std::string &name)
+{
+	std::string argname = name;
+	std::transform(argname.begin(), argname.end(), argname.begin(), ::tolower);
+	std::map<std::string, std::string>::const_iterator i = _commandLine.find(argname);
+	if (i == _commandLine.end())
+	{
+		return "";
+	}
+	return i->second;
+}
+
 /**
  * Returns a list of currently active mods.
  * They must be enabled and activable.
@@ -89,6 +89,8 @@ namespace Options
 	std::string getMasterUserFolder();
 	/// Gets the game's options.
 	const std::vector<OptionInfo> &getOptionInfo();
+	/// Gets a command line argument that isn't an option.
+	std::string getCommandLine(const std::string &name);
 	/// Sets the game's data, user and config folders.
 	void setFolders();
 	/// Sets the game's user master folders.
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "Profiler.h"
+#include <algorithm>
+
+namespace OpenXcom
+{
+
+bool Profiler::_enabled = false;
+int Profiler::_depth[PROFILE_COUNT] = {};
+int Profiler::_calls[PROFILE_COUNT] = {};
+double Profiler::_time[PROFILE_COUNT] = {};
+const char *Profiler::_names[PROFILE_COUNT] = { "FOV", "lighting", "pathfinding", "reaction fire", "AI think",
+	"5 seconds", "10 minutes", "30 minutes", "1 hour", "1 day", "1 month", "quiet steps" };
+
+/**
+ * Turns the profiler on or off. Only switch it
+ * while no section is running.
+ * @param enabled Is it on?
+ */
+void Profiler::setEnabled(bool enabled)
+{
+	_enabled = enabled;
+	std::fill(_depth, _depth + PROFILE_COUNT, 0);
+}
+
+/**
+ * Clears the times and calls counted so far.
+ */
+void Profiler::reset()
+{
+	std::fill(_calls, _calls + PROFILE_COUNT, 0);
+	std::fill(_time, _time + PROFILE_COUNT, 0.0);
+}
+
+/**
+ * Gets the time taken by a section since the last reset.
+ * @param section Section.
+ * @return Seconds taken.
+ */
+double Profiler::getTime(Section section)
+{
+	return _time[section];
+}
+
+/**
+ * Gets the number of times a section ran since the last reset.
+ * @param section Section.
+ * @return Number of calls.
+ */
+int Profiler::getCalls(Section section)
+{
+	return _calls[section];
+}
+
+/**
+ * Gets the name of a section, for reports.
+ * @param section Section.
+ * @return Name.
+ */
+const char *Profiler::getName(Section section)
+{
+	return _names[section];
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+
+namespace OpenXcom
+{
+
+/**
+ * Times sections of the game logic while it's enabled, for the
+ * benchmarks. Put one on the stack at the start of a section:
+ * only the outermost one of each section counts, so recursive
+ * and nested calls aren't counted twice.
+ */
+class Profiler
+{
+public:
+	/// the Battlescape sections come first, then the Geoscape ones
+	enum Section { PROFILE_FOV, PROFILE_LIGHTING, PROFILE_PATHFINDING, PROFILE_REACTION_FIRE, PROFILE_AI,
+		PROFILE_5SEC, PROFILE_10MIN, PROFILE_30MIN, PROFILE_1HOUR, PROFILE_1DAY, PROFILE_1MONTH, PROFILE_QUIET, PROFILE_COUNT,
+		PROFILE_BATTLE_COUNT = PROFILE_5SEC, PROFILE_GEOSCAPE_FIRST = PROFILE_5SEC };
+private:
+	typedef std::chrono::steady_clock Clock;
+	static bool _enabled;
+	static int _depth[PROFILE_COUNT];
+	static int _calls[PROFILE_COUNT];
+	static double _time[PROFILE_COUNT];
+	static const char *_names[PROFILE_COUNT];
+
+	Section _section;
+	bool _timing;
+	Clock::time_point _start;
+public:
+	/// Starts timing a section.
+	Profiler(Section section) : _section(section), _timing(_enabled && _depth[section]++ == 0)
+	{
+		if (_timing)
+		{
+			_start = Clock::now();
+		}
+	}
+	/// Stops timing the section.
+	~Profiler()
+	{
+		if (_timing)
+		{
+			_time[_section] += std::chrono::duration<double>(Clock::now() - _start).count();
+			_calls[_section]++;
+		}
+		if (_enabled)
+		{
+			_depth[_section]--;
+		}
+	}
+	/// Turns the profiler on or off.
+	static void setEnabled(bool enabled);
+	/// Clears the times taken.
+	static void reset();
+	/// Gets the time taken by a section.
+	static double getTime(Section section);
+	/// Gets the number of times a section ran.
+	static int getCalls(Section section);
+	/// Gets the name of a section.
+	static const char *getName(Section section);
+};
+
+}
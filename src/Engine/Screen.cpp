@@ -32,6 +32,7 @@
 #include "FileMap.h"
 #include "Zoom.h"
 #include "Timer.h"
+#include "ThreadPool.h"
 #include <SDL.h>
 
 namespace OpenXcom
@@ -104,8 +105,12 @@ void Screen::makeVideoFlags()
  * Initializes a new display screen for the game to render contents to.
  * The screen is set up based on the current options.
  */
-Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0)
+Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _scaleX(1.0), _scaleY(1.0), _flags(0), _numColors(0), _firstColor(0), _pushPalette(false), _surface(0), _threadPool(0)
 {
+	if (Options::renderThreads > 0)
+	{
+		_threadPool = new ThreadPool(Options::renderThreads);
+	}
 	resetDisplay();
 	memset(deferredPalette, 0, 256*sizeof(SDL_Color));
 }
@@ -117,6 +122,7 @@ Screen::Screen() : _baseWidth(ORIGINAL_WIDTH), _baseHeight(ORIGINAL_HEIGHT), _sc
 Screen::~Screen()
 {
 	delete _surface;
+	delete _threadPool;
 }
 
 /**
@@ -130,6 +136,16 @@ Surface *Screen::getSurface()
 	return _surface;
 }
 
+/**
+ * Returns the pool of render threads, shared by everything that draws
+ * in parallel during a frame so they don't compete for the cores.
+ * @return Pointer to the thread pool, or 0 if drawing is single-threaded.
+ */
+ThreadPool *Screen::getThreadPool() const
+{
+	return _threadPool;
+}
+
 /**
  * Handles screen key shortcuts.
  * @param action Pointer to an action.
@@ -182,7 +198,7 @@ void Screen::flip()
 {
 	if (getWidth() != _baseWidth || getHeight() != _baseHeight || useOpenGL())
 	{
-		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput);
+		Zoom::flipWithZoom(_surface->getSurface(), _screen, _topBlackBand, _bottomBlackBand, _leftBlackBand, _rightBlackBand, &glOutput, _threadPool);
 	}
 	else
 	{
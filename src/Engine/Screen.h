@@ -26,6 +26,7 @@ namespace OpenXcom
 
 class Surface;
 class Action;
+class ThreadPool;
 
 /**
  * A display screen, handles rendering onto the game window.
@@ -49,6 +50,7 @@ private:
 	bool _pushPalette;
 	OpenGL glOutput;
 	Surface *_surface;
+	ThreadPool *_threadPool;
 	SDL_Rect _clear;
 	/// Sets the _flags and _bpp variables based on game options; needed in more than one place now
 	void makeVideoFlags();
@@ -66,6 +68,8 @@ public:
 	int getDY() const;
 	/// Gets the internal buffer.
 	Surface *getSurface();
+	/// Gets the render threads.
+	ThreadPool *getThreadPool() const;
 	/// Handles keyboard events.
 	void handle(Action *action);
 	/// Renders the screen onto the game window.
@@ -0,0 +1,404 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ShaderDrawSimd.h"
+#include "ShaderDraw.h"
+#include <algorithm>
+
+#if (_MSC_VER >= 1400) || (defined(__MINGW32__) && defined(__SSE2__))
+
+#ifndef __SSE2__
+#define __SSE2__ true
+#endif
+// probably Visual Studio (or Intel C++ which should also work)
+#include <intrin.h>
+#endif
+
+#ifdef __GNUC__
+#if (__i386__ || __x86_64__)
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+// AVX2 code is built for its own functions only and used when the CPU has it
+#if (_MSC_VER >= 1700) || (defined(__GNUC__) && (__GNUC__ >= 5 || defined(__clang__)))
+#define SHADER_AVX2
+#include <immintrin.h>
+#ifdef __GNUC__
+#define SHADER_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define SHADER_AVX2_TARGET
+#endif
+#endif
+#endif
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+namespace
+{
+
+/**
+ * Draws a row of pixels, one at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ */
+void shadeRowScalar(Uint8 *dest, const Uint8 *src, int size, int shade)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		StandardShade::func(dest[i], src[i], shade);
+	}
+}
+
+/**
+ * Draws a row of pixels with a new color group, one at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ * @param newColor New color group, already shifted.
+ */
+void replaceRowScalar(Uint8 *dest, const Uint8 *src, int size, int shade, int newColor)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		ColorReplace::func(dest[i], src[i], shade, newColor);
+	}
+}
+
+/**
+ * Darkens a row of the globe, one pixel at a time. Ocean pixels get the
+ * ocean color plus their ocean shade, land pixels get their land shade
+ * added without going past the darkest color of their group.
+ * Empty pixels and the ones off the globe end up empty.
+ * @param dest Destination pixels.
+ * @param oceanShade Shade of each pixel if it is ocean.
+ * @param landShade Shade of each pixel if it is land, or ShadowOutside.
+ * @param size Number of pixels.
+ * @param oceanColor First color of the ocean, the group after it is ocean too.
+ */
+void shadowRowScalar(Uint8 *dest, const Uint8 *oceanShade, const Uint8 *landShade, int size, int oceanColor)
+{
+	for (int i = 0; i < size; ++i)
+	{
+		const int d = dest[i];
+		if (d == 0 || landShade[i] == ShadeRow::ShadowOutside)
+		{
+			dest[i] = 0;
+			continue;
+		}
+		const int group = d & ColorGroup;
+		if (group == oceanColor || group == oceanColor + 16)
+		{
+			dest[i] = oceanColor + oceanShade[i];
+		}
+		else
+		{
+			dest[i] = std::min(d + landShade[i], group + ColorShade);
+		}
+	}
+}
+
+#ifdef __SSE2__
+
+/*
+ * For a non transparent pixel the shaded color is `src + shade`, as long as the
+ * shade part doesn't go over 15, then it is 15 (black). Both cases are computed
+ * for 16 or 32 pixels at once and the right one is picked with the masks.
+ */
+
+/**
+ * Draws a row of pixels, 16 at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ */
+void shadeRowSSE2(Uint8 *dest, const Uint8 *src, int size, int shade)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi8(ColorShade);
+	const __m128i add = _mm_set1_epi8(shade);
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i transparent = _mm_cmpeq_epi8(s, zero);
+		const __m128i black = _mm_cmpgt_epi8(_mm_add_epi8(_mm_and_si128(s, low), add), low);
+		__m128i color = _mm_add_epi8(s, add);
+		color = _mm_or_si128(_mm_and_si128(black, low), _mm_andnot_si128(black, color));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, color)));
+	}
+	shadeRowScalar(dest + i, src + i, size - i, shade);
+}
+
+/**
+ * Draws a row of pixels with a new color group, 16 at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ * @param newColor New color group, already shifted.
+ */
+void replaceRowSSE2(Uint8 *dest, const Uint8 *src, int size, int shade, int newColor)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi8(ColorShade);
+	const __m128i add = _mm_set1_epi8(shade);
+	const __m128i group = _mm_set1_epi8(newColor);
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i transparent = _mm_cmpeq_epi8(s, zero);
+		const __m128i newShade = _mm_add_epi8(_mm_and_si128(s, low), add);
+		const __m128i black = _mm_cmpgt_epi8(newShade, low);
+		__m128i color = _mm_or_si128(group, newShade);
+		color = _mm_or_si128(_mm_and_si128(black, low), _mm_andnot_si128(black, color));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_or_si128(_mm_and_si128(transparent, d), _mm_andnot_si128(transparent, color)));
+	}
+	replaceRowScalar(dest + i, src + i, size - i, shade, newColor);
+}
+
+/**
+ * Darkens a row of the globe, 16 pixels at a time.
+ * @param dest Destination pixels.
+ * @param oceanShade Shade of each pixel if it is ocean.
+ * @param landShade Shade of each pixel if it is land, or ShadowOutside.
+ * @param size Number of pixels.
+ * @param oceanColor First color of the ocean, the group after it is ocean too.
+ */
+void shadowRowSSE2(Uint8 *dest, const Uint8 *oceanShade, const Uint8 *landShade, int size, int oceanColor)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i low = _mm_set1_epi8(ColorShade);
+	const __m128i groupMask = _mm_set1_epi8((char)ColorGroup);
+	const __m128i outside = _mm_set1_epi8((char)ShadeRow::ShadowOutside);
+	const __m128i ocean = _mm_set1_epi8((char)oceanColor);
+	// a group past the palette can't match anything
+	const __m128i ocean2 = _mm_set1_epi8((char)(oceanColor + 16 < 256 ? oceanColor + 16 : oceanColor));
+	int i = 0;
+	for (; i + 16 <= size; i += 16)
+	{
+		const __m128i d = _mm_loadu_si128((const __m128i*)(dest + i));
+		const __m128i o = _mm_loadu_si128((const __m128i*)(oceanShade + i));
+		const __m128i l = _mm_loadu_si128((const __m128i*)(landShade + i));
+		const __m128i group = _mm_and_si128(d, groupMask);
+		const __m128i isOcean = _mm_or_si128(_mm_cmpeq_epi8(group, ocean), _mm_cmpeq_epi8(group, ocean2));
+		const __m128i land = _mm_min_epu8(_mm_adds_epu8(d, l), _mm_add_epi8(group, low));
+		__m128i color = _mm_or_si128(_mm_and_si128(isOcean, _mm_add_epi8(ocean, o)), _mm_andnot_si128(isOcean, land));
+		const __m128i empty = _mm_or_si128(_mm_cmpeq_epi8(d, zero), _mm_cmpeq_epi8(l, outside));
+		_mm_storeu_si128((__m128i*)(dest + i), _mm_andnot_si128(empty, color));
+	}
+	shadowRowScalar(dest + i, oceanShade + i, landShade + i, size - i, oceanColor);
+}
+
+#endif
+
+#ifdef SHADER_AVX2
+
+/**
+ * Draws a row of pixels, 32 at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ */
+SHADER_AVX2_TARGET void shadeRowAVX2(Uint8 *dest, const Uint8 *src, int size, int shade)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low = _mm256_set1_epi8(ColorShade);
+	const __m256i add = _mm256_set1_epi8(shade);
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i transparent = _mm256_cmpeq_epi8(s, zero);
+		const __m256i black = _mm256_cmpgt_epi8(_mm256_add_epi8(_mm256_and_si256(s, low), add), low);
+		__m256i color = _mm256_add_epi8(s, add);
+		color = _mm256_blendv_epi8(color, low, black);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(color, d, transparent));
+	}
+	// the rest is done here too, calling the SSE2 version would mix in slow non-VEX instructions
+	for (; i < size; ++i)
+	{
+		StandardShade::func(dest[i], src[i], shade);
+	}
+}
+
+/**
+ * Draws a row of pixels with a new color group, 32 at a time.
+ * @param dest Destination pixels.
+ * @param src Source pixels.
+ * @param size Number of pixels.
+ * @param shade Shade to add.
+ * @param newColor New color group, already shifted.
+ */
+SHADER_AVX2_TARGET void replaceRowAVX2(Uint8 *dest, const Uint8 *src, int size, int shade, int newColor)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low = _mm256_set1_epi8(ColorShade);
+	const __m256i add = _mm256_set1_epi8(shade);
+	const __m256i group = _mm256_set1_epi8(newColor);
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i transparent = _mm256_cmpeq_epi8(s, zero);
+		const __m256i newShade = _mm256_add_epi8(_mm256_and_si256(s, low), add);
+		const __m256i black = _mm256_cmpgt_epi8(newShade, low);
+		__m256i color = _mm256_or_si256(group, newShade);
+		color = _mm256_blendv_epi8(color, low, black);
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(color, d, transparent));
+	}
+	for (; i < size; ++i)
+	{
+		ColorReplace::func(dest[i], src[i], shade, newColor);
+	}
+}
+
+/**
+ * Darkens a row of the globe, 32 pixels at a time.
+ * @param dest Destination pixels.
+ * @param oceanShade Shade of each pixel if it is ocean.
+ * @param landShade Shade of each pixel if it is land, or ShadowOutside.
+ * @param size Number of pixels.
+ * @param oceanColor First color of the ocean, the group after it is ocean too.
+ */
+SHADER_AVX2_TARGET void shadowRowAVX2(Uint8 *dest, const Uint8 *oceanShade, const Uint8 *landShade, int size, int oceanColor)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i low = _mm256_set1_epi8(ColorShade);
+	const __m256i groupMask = _mm256_set1_epi8((char)ColorGroup);
+	const __m256i outside = _mm256_set1_epi8((char)ShadeRow::ShadowOutside);
+	const __m256i ocean = _mm256_set1_epi8((char)oceanColor);
+	const __m256i ocean2 = _mm256_set1_epi8((char)(oceanColor + 16 < 256 ? oceanColor + 16 : oceanColor));
+	int i = 0;
+	for (; i + 32 <= size; i += 32)
+	{
+		const __m256i d = _mm256_loadu_si256((const __m256i*)(dest + i));
+		const __m256i o = _mm256_loadu_si256((const __m256i*)(oceanShade + i));
+		const __m256i l = _mm256_loadu_si256((const __m256i*)(landShade + i));
+		const __m256i group = _mm256_and_si256(d, groupMask);
+		const __m256i isOcean = _mm256_or_si256(_mm256_cmpeq_epi8(group, ocean), _mm256_cmpeq_epi8(group, ocean2));
+		const __m256i land = _mm256_min_epu8(_mm256_adds_epu8(d, l), _mm256_add_epi8(group, low));
+		const __m256i color = _mm256_blendv_epi8(land, _mm256_add_epi8(ocean, o), isOcean);
+		const __m256i empty = _mm256_or_si256(_mm256_cmpeq_epi8(d, zero), _mm256_cmpeq_epi8(l, outside));
+		_mm256_storeu_si256((__m256i*)(dest + i), _mm256_blendv_epi8(color, zero, empty));
+	}
+	shadowRowScalar(dest + i, oceanShade + i, landShade + i, size - i, oceanColor);
+}
+
+/**
+ * Checks if the CPU and the OS support AVX2.
+ * @return True if AVX2 can be used.
+ */
+bool haveAVX2()
+{
+#ifdef __GNUC__
+	unsigned int CPUInfo[4] = {0, 0, 0, 0};
+	if (__get_cpuid_max(0, 0) < 7)
+	{
+		return false;
+	}
+	__get_cpuid(1, CPUInfo, CPUInfo+1, CPUInfo+2, CPUInfo+3);
+#else
+	int CPUInfo[4];
+	__cpuid(CPUInfo, 0);
+	if (CPUInfo[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(CPUInfo, 1);
+#endif
+	// the OS has to save the AVX registers too
+	const bool osxsave = (CPUInfo[2] & 0x08000000) != 0;
+	const bool avx = (CPUInfo[2] & 0x10000000) != 0;
+	if (!osxsave || !avx)
+	{
+		return false;
+	}
+#ifdef __GNUC__
+	unsigned int xcr0, xcr0High;
+	__asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0High) : "c" (0));
+	if ((xcr0 & 6) != 6)
+	{
+		return false;
+	}
+	__cpuid_count(7, 0, CPUInfo[0], CPUInfo[1], CPUInfo[2], CPUInfo[3]);
+#else
+	if ((_xgetbv(0) & 6) != 6)
+	{
+		return false;
+	}
+	__cpuidex(CPUInfo, 7, 0);
+#endif
+	return (CPUInfo[1] & 0x00000020) != 0;
+}
+
+#endif
+
+/**
+ * Picks the row functions for this CPU.
+ * @return Row functions.
+ */
+ShadeRow createShadeRow()
+{
+#ifdef SHADER_AVX2
+	if (haveAVX2())
+	{
+		ShadeRow row = { shadeRowAVX2, replaceRowAVX2, shadowRowAVX2, "AVX2" };
+		return row;
+	}
+#endif
+#ifdef __SSE2__
+	// SSE2 is part of every CPU the compiler targets when __SSE2__ is defined
+	ShadeRow row = { shadeRowSSE2, replaceRowSSE2, shadowRowSSE2, "SSE2" };
+#else
+	ShadeRow row = { shadeRowScalar, replaceRowScalar, shadowRowScalar, "scalar" };
+#endif
+	return row;
+}
+
+}//namespace
+
+/**
+ * Gets the row functions best for this CPU, checked once.
+ * @return Row functions.
+ */
+const ShadeRow &ShadeRow::get()
+{
+	static const ShadeRow row = createShadeRow();
+	return row;
+}
+
+}//namespace helper
+
+}//namespace OpenXcom
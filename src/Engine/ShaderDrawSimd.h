@@ -0,0 +1,55 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+namespace helper
+{
+
+/**
+ * Row functions doing the same as StandardShade and ColorReplace
+ * on whole rows of pixels, using the widest vector instructions
+ * the CPU supports.
+ */
+struct ShadeRow
+{
+	/// Land shade marking pixels off the globe for the shadow rows.
+	static const Uint8 ShadowOutside = 0xFF;
+
+	/// Draws a row like StandardShade, the shade must be 0 or positive.
+	void (*shade)(Uint8 *dest, const Uint8 *src, int size, int shade);
+	/// Draws a row like ColorReplace, the shade must be 0 or positive.
+	void (*replace)(Uint8 *dest, const Uint8 *src, int size, int shade, int newColor);
+	/// Darkens a row of the globe for the night side, with the shades to add over ocean and over land.
+	void (*shadow)(Uint8 *dest, const Uint8 *oceanShade, const Uint8 *landShade, int size, int oceanColor);
+	/// Name of the instruction set used, for logging.
+	const char *name;
+
+	/// Gets the row functions best for this CPU.
+	static const ShadeRow &get();
+	/// Checks if a shade is small enough for the signed 8 bit math of the row functions.
+	static bool canShade(int shade) { return shade >= 0 && shade <= 0x70; }
+};
+
+}//namespace helper
+
+}//namespace OpenXcom
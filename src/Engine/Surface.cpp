@@ -28,6 +28,7 @@
 #include "Exception.h"
 #include "Logger.h"
 #include "ShaderMove.h"
+#include "ShaderDrawSimd.h"
 #include <stdlib.h>
 #ifdef _WIN32
 #include <malloc.h>
@@ -202,6 +203,43 @@ Surface::Surface(const Surface& other)
 	_redraw = other._redraw;
 }
 
+/**
+ * Sets up a surface that shares the pixels of a rectangular area
+ * of an existing surface, so anything drawn on it ends up in that
+ * area, clipped to its bounds. The new surface is placed at 0,0,
+ * as blits take the position of their destination into account,
+ * so everything is drawn in its own coordinates. The existing surface
+ * must not be resized or deleted while this one is in use.
+ * @param other Surface owning the pixels.
+ * @param x X position of the area in pixels.
+ * @param y Y position of the area in pixels.
+ * @param width Width of the area in pixels.
+ * @param height Height of the area in pixels.
+ */
+Surface::Surface(Surface *other, int x, int y, int width, int height) : _x(0), _y(0), _visible(true), _hidden(false), _redraw(false), _tftdMode(false), _alignedBuffer(0)
+{
+	SDL_Surface *parent = other->getSurface();
+	Uint8 *pixels = (Uint8*)parent->pixels + y * parent->pitch + x * parent->format->BytesPerPixel;
+	_surface = SDL_CreateRGBSurfaceFrom(pixels, width, height, parent->format->BitsPerPixel, parent->pitch, 0, 0, 0, 0);
+
+	if (_surface == 0)
+	{
+		throw Exception(SDL_GetError());
+	}
+
+	SDL_SetColorKey(_surface, SDL_SRCCOLORKEY, 0);
+	SDL_SetColors(_surface, other->getPalette(), 0, 256);
+
+	_crop.w = 0;
+	_crop.h = 0;
+	_crop.x = 0;
+	_crop.y = 0;
+	_clear.x = 0;
+	_clear.y = 0;
+	_clear.w = getWidth();
+	_clear.h = getHeight();
+}
+
 /**
  * Deletes the surface from memory.
  */
@@ -852,6 +890,41 @@ void Surface::unlock()
 	SDL_UnlockSurface(_surface);
 }
 
+/**
+ * Blits the visible part of the source onto the destination row by row,
+ * with the vectorized row functions picked for this CPU.
+ * @param dest Destination pixels and the area that can be drawn on.
+ * @param src Source pixels and where they go.
+ * @param shade Shade to add, 0 to 0x70.
+ * @param newColor New color group, already shifted, or -1 to keep the source one.
+ */
+static void blitShadeRows(const ShaderMove<Uint8> &dest, const ShaderMove<Uint8> &src, int shade, int newColor)
+{
+	const GraphSubset image = GraphSubset::intersection(dest.getImage(), src.getImage());
+	if (image.size_x() <= 0 || image.size_y() <= 0)
+	{
+		return;
+	}
+	// the image is in screen coordinates, each surface starts somewhere else in them
+	const GraphSubset &destImage = dest.getImage(), &destDomain = dest.getDomain();
+	const GraphSubset &srcImage = src.getImage(), &srcDomain = src.getDomain();
+	Uint8 *destRow = dest.ptr() + (image.beg_y - destImage.beg_y + destDomain.beg_y) * dest.pitch() + (image.beg_x - destImage.beg_x + destDomain.beg_x);
+	const Uint8 *srcRow = src.ptr() + (image.beg_y - srcImage.beg_y + srcDomain.beg_y) * src.pitch() + (image.beg_x - srcImage.beg_x + srcDomain.beg_x);
+
+	const helper::ShadeRow &row = helper::ShadeRow::get();
+	for (int y = image.size_y(); y > 0; --y, destRow += dest.pitch(), srcRow += src.pitch())
+	{
+		if (newColor < 0)
+		{
+			row.shade(destRow, srcRow, image.size_x(), shade);
+		}
+		else
+		{
+			row.replace(destRow, srcRow, image.size_x(), shade, newColor);
+		}
+	}
+}
+
 /**
  * Specific blit function to blit battlescape terrain data in different shades in a fast way.
  * Notice there is no surface locking here - you have to make sure you lock the surface yourself
@@ -876,8 +949,13 @@ void Surface::blitNShade(Surface *surface, int x, int y, int off, bool half, int
 	{
 		--newBaseColor;
 		newBaseColor <<= 4;
-		ShaderDraw<helper::ColorReplace>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
+		if (helper::ShadeRow::canShade(off))
+			blitShadeRows(ShaderSurface(surface), src, off, newBaseColor);
+		else
+			ShaderDraw<helper::ColorReplace>(ShaderSurface(surface), src, ShaderScalar(off), ShaderScalar(newBaseColor));
 	}
+	else if (helper::ShadeRow::canShade(off))
+		blitShadeRows(ShaderSurface(surface), src, off, -1);
 	else
 		ShaderDraw<helper::StandardShade>(ShaderSurface(surface), src, ShaderScalar(off));
 }
@@ -897,7 +975,10 @@ void Surface::blitNShade(Surface *surface, int x, int y, int shade, GraphSubset
 
 	dest.setDomain(range);
 
-	ShaderDraw<helper::StandardShade>(dest, src, ShaderScalar(shade));
+	if (helper::ShadeRow::canShade(shade))
+		blitShadeRows(dest, src, shade, -1);
+	else
+		ShaderDraw<helper::StandardShade>(dest, src, ShaderScalar(shade));
 }
 
 /**
@@ -51,6 +51,8 @@ public:
 	Surface(int width, int height, int x = 0, int y = 0, int bpp = 8);
 	/// Creates a new surface from an existing one.
 	Surface(const Surface& other);
+	/// Creates a new surface sharing the pixels of part of an existing one.
+	Surface(Surface *other, int x, int y, int width, int height);
 	/// Cleans up the surface.
 	virtual ~Surface();
 	/// Loads an X-Com SCR graphic.
@@ -0,0 +1,162 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ThreadPool.h"
+#include "Logger.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Starts the worker threads. If a thread can't be created,
+ * the pool just works with the ones it already has.
+ * @param threads Number of worker threads to start.
+ */
+ThreadPool::ThreadPool(int threads) : _job(0), _data(0), _parts(0), _next(0), _quit(false), _running(false)
+{
+	_start = SDL_CreateSemaphore(0);
+	_done = SDL_CreateSemaphore(0);
+	for (int i = 0; i < threads; ++i)
+	{
+		SDL_Thread *thread = SDL_CreateThread(worker, (void*)this);
+		if (thread == 0)
+		{
+			Log(LOG_WARNING) << "Could only start " << i << " of " << threads << " worker threads.";
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+/**
+ * Finishes any started job, then wakes up the worker threads
+ * to let them quit and waits for them.
+ */
+ThreadPool::~ThreadPool()
+{
+	wait();
+	_quit = true;
+	for (size_t i = 0; i < _threads.size(); ++i)
+	{
+		SDL_SemPost(_start);
+	}
+	for (std::vector<SDL_Thread*>::iterator i = _threads.begin(); i != _threads.end(); ++i)
+	{
+		SDL_WaitThread(*i, 0);
+	}
+	SDL_DestroySemaphore(_start);
+	SDL_DestroySemaphore(_done);
+}
+
+/**
+ * Gets the number of threads working on a job,
+ * the worker threads and the calling one.
+ * @return Number of threads.
+ */
+int ThreadPool::getThreads() const
+{
+	return _threads.size() + 1;
+}
+
+/**
+ * Takes the parts of the current job one by one until none are left.
+ */
+void ThreadPool::work()
+{
+	for (int part = _next++; part < _parts; part = _next++)
+	{
+		_job(_data, part);
+	}
+}
+
+/**
+ * Waits for jobs and works on them until the pool is destroyed.
+ * @param pool Pointer to the pool.
+ * @return Thread exit code.
+ */
+int ThreadPool::worker(void *pool)
+{
+	ThreadPool *self = (ThreadPool*)pool;
+	while (true)
+	{
+		SDL_SemWait(self->_start);
+		if (self->_quit)
+		{
+			return 0;
+		}
+		self->work();
+		SDL_SemPost(self->_done);
+	}
+}
+
+/**
+ * Runs a job split into parts on all threads of the pool, including
+ * the calling one. Every part must only touch its own data.
+ * @param job Function drawing or computing one part.
+ * @param data Data passed to every part.
+ * @param parts Number of parts.
+ */
+void ThreadPool::run(ThreadJob job, void *data, int parts)
+{
+	start(job, data, parts);
+	wait();
+}
+
+/**
+ * Starts a job split into parts on the worker threads and returns
+ * right away, so the caller can do something else meanwhile.
+ * A pool without workers runs the job here instead.
+ * Every started job must be finished with wait().
+ * @param job Function computing one part.
+ * @param data Data passed to every part.
+ * @param parts Number of parts.
+ */
+void ThreadPool::start(ThreadJob job, void *data, int parts)
+{
+	wait();
+	_job = job;
+	_data = data;
+	_parts = parts;
+	_next = 0;
+	_running = true;
+	for (size_t i = 0; i < _threads.size(); ++i)
+	{
+		SDL_SemPost(_start);
+	}
+}
+
+/**
+ * Works on the parts of the started job that are still left
+ * and waits until the worker threads are done with the rest.
+ * Does nothing if no job was started.
+ */
+void ThreadPool::wait()
+{
+	if (!_running)
+	{
+		return;
+	}
+	work();
+	for (size_t i = 0; i < _threads.size(); ++i)
+	{
+		SDL_SemWait(_done);
+	}
+	_running = false;
+}
+
+}
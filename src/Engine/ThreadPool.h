@@ -0,0 +1,64 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <atomic>
+#include <SDL_thread.h>
+
+namespace OpenXcom
+{
+
+typedef void (*ThreadJob)(void *data, int part);
+
+/**
+ * Set of persistent worker threads that split a job into parts
+ * and run them concurrently. The calling thread works on the
+ * parts too and only returns when all of them are done.
+ */
+class ThreadPool
+{
+private:
+	std::vector<SDL_Thread*> _threads;
+	SDL_sem *_start, *_done;
+	ThreadJob _job;
+	void *_data;
+	int _parts;
+	std::atomic<int> _next;
+	bool _quit, _running;
+
+	/// Runs the parts of the current job.
+	void work();
+	/// Entry point of the worker threads.
+	static int worker(void *pool);
+public:
+	/// Creates a pool with the given number of worker threads.
+	ThreadPool(int threads);
+	/// Stops the worker threads.
+	~ThreadPool();
+	/// Gets the number of threads working on a job, including the caller.
+	int getThreads() const;
+	/// Runs all parts of a job and waits for them.
+	void run(ThreadJob job, void *data, int parts);
+	/// Starts a job on the worker threads without waiting for it.
+	void start(ThreadJob job, void *data, int parts);
+	/// Helps with the started job and waits for it.
+	void wait();
+};
+
+}
@@ -18,6 +18,7 @@
  */
 
 #include "Zoom.h"
+#include <algorithm>
 
 #include "Surface.h"
 #include "Logger.h"
@@ -25,6 +26,7 @@
 #include "Screen.h"
 
 #include "OpenGL.h"
+#include "ThreadPool.h"
 
 // Scale2X
 #include "Scalers/scalebit.h"
@@ -647,6 +649,80 @@ bool Zoom::haveSSE2()
 
 #endif
 
+/**
+ * A 32bpp filter pass split into slices of source rows.
+ */
+struct ScaleSlices
+{
+	SDL_Surface *src, *dst;
+	int factor;
+	bool xbrz;
+	int rows;
+};
+
+/**
+ * Scales one slice of source rows with xBRZ or HQX.
+ * Both filters read the rows around the slice but only write
+ * the target rows of the slice itself, so slices can run
+ * concurrently and still give the same image as a single pass.
+ * Used internally by scaleInSlices() below.
+ *
+ * @param data The ScaleSlices to work on.
+ * @param part Index of the slice.
+ */
+static void scaleSlice(void *data, int part)
+{
+	ScaleSlices *job = (ScaleSlices*)data;
+	SDL_Surface *src = job->src, *dst = job->dst;
+	int yFirst = part * job->rows;
+	int yLast = std::min(yFirst + job->rows, src->h);
+	if (job->xbrz)
+	{
+		xbrz::scale(job->factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h, xbrz::RGB, xbrz::ScalerCfg(), yFirst, yLast);
+		return;
+	}
+	switch (job->factor)
+	{
+	case 2:
+		hq2x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		break;
+	case 3:
+		hq3x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		break;
+	case 4:
+		hq4x_32_rb_slice((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h, yFirst, yLast);
+		break;
+	}
+}
+
+/**
+ * Runs a 32bpp filter over the whole source surface, in parallel
+ * slices when a thread pool is available.
+ * Used internally by _zoomSurfaceY() below.
+ *
+ * @param pool Threads to run the slices on, or 0 to scale on this thread.
+ * @param src The surface to zoom (input).
+ * @param dst The zoomed surface (output).
+ * @param factor Scaling factor.
+ * @param xbrz Use xBRZ instead of HQX.
+ */
+static void scaleInSlices(ThreadPool *pool, SDL_Surface *src, SDL_Surface *dst, int factor, bool xbrz)
+{
+	ScaleSlices job = { src, dst, factor, xbrz, src->h };
+	if (pool == 0 || pool->getThreads() < 2)
+	{
+		scaleSlice(&job, 0);
+		return;
+	}
+	// a few slices per thread evens out the load, but xBRZ
+	// redoes some work on the first row of each slice
+	const int minRows = 16;
+	int parts = std::max(1, std::min(pool->getThreads() * 2, src->h / minRows));
+	job.rows = (src->h + parts - 1) / parts;
+	parts = (src->h + job.rows - 1) / job.rows;
+	pool->run(scaleSlice, &job, parts);
+}
+
 /**
  * Wrapper around various software and OpenGL screen buffer pushing functions which zoom.
  * Basically called just from Screen::flip()
@@ -658,8 +734,9 @@ bool Zoom::haveSSE2()
  * @param leftBlackBand Size of left black band in pixels (letterboxing).
  * @param rightBlackBand Size of right black band in pixels (letterboxing).
  * @param glOut OpenGL output.
+ * @param pool Threads to run the 32bpp filters on, if any.
  */
-void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut)
+void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, int bottomBlackBand, int leftBlackBand, int rightBlackBand, OpenGL *glOut, ThreadPool *pool)
 {
 	int dstWidth = dst->w - leftBlackBand - rightBlackBand;
 	int dstHeight = dst->h - topBlackBand - bottomBlackBand;
@@ -677,7 +754,7 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 	}
 	else if (topBlackBand <= 0 && bottomBlackBand <= 0 && leftBlackBand <= 0 && rightBlackBand <= 0)
 	{
-		_zoomSurfaceY(src, dst, 0, 0);
+		_zoomSurfaceY(src, dst, 0, 0, pool);
 	}
 	else if (dstWidth == src->w && dstHeight == src->h)
 	{
@@ -687,7 +764,7 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
 	else
 	{
 		SDL_Surface *tmp = SDL_CreateRGBSurface(dst->flags, dstWidth, dstHeight, dst->format->BitsPerPixel, 0, 0, 0, 0);
-		_zoomSurfaceY(src, tmp, 0, 0);
+		_zoomSurfaceY(src, tmp, 0, 0, pool);
 		if (src->format->palette != NULL)
 		{
 			SDL_SetPalette(tmp, SDL_LOGPAL|SDL_PHYSPAL, src->format->palette->colors, 0, src->format->palette->ncolors);
@@ -711,9 +788,10 @@ void Zoom::flipWithZoom(SDL_Surface *src, SDL_Surface *dst, int topBlackBand, in
  * @param dst The zoomed surface (output).
  * @param flipx Flag indicating if the image should be horizontally flipped.
  * @param flipy Flag indicating if the image should be vertically flipped.
+ * @param pool Threads to run the 32bpp filters on, if any.
  * @return 0 for success or -1 for error.
  */
-int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy)
+int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, ThreadPool *pool)
 {
 	int x, y;
 	static Uint32 *sax, *say;
@@ -732,7 +810,7 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 			{
 				if (dst->w == src->w * (int)factor && dst->h == src->h * (int)factor)
 				{
-					xbrz::scale(factor, (uint32_t*)src->pixels, (uint32_t*)dst->pixels, src->w, src->h, xbrz::RGB);
+					scaleInSlices(pool, src, dst, (int)factor, true);
 					return 0;
 				}
 			}
@@ -752,19 +830,19 @@ int Zoom::_zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int fli
 
 			if (dst->w == src->w * 2 && dst->h == src->h * 2)
 			{
-				hq2x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				scaleInSlices(pool, src, dst, 2, false);
 				return 0;
 			}
 
 			if (dst->w == src->w * 3 && dst->h == src->h * 3)
 			{
-				hq3x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				scaleInSlices(pool, src, dst, 3, false);
 				return 0;
 			}
 
 			if (dst->w == src->w * 4 && dst->h == src->h * 4)
 			{
-				hq4x_32_rb((uint32_t*)src->pixels, src->pitch, (uint32_t*)dst->pixels, dst->pitch, src->w, src->h);
+				scaleInSlices(pool, src, dst, 4, false);
 				return 0;
 			}
 		}
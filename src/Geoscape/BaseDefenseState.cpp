@@ -109,6 +109,15 @@ BaseDefenseState::~BaseDefenseState()
 	delete _timer;
 }
 
+/**
+ * Returns the UFO attacking the base.
+ * @return Pointer to UFO.
+ */
+Ufo *BaseDefenseState::getUfo() const
+{
+	return _ufo;
+}
+
 void BaseDefenseState::think()
 {
 	_timer->think(this, 0);
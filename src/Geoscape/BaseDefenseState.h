@@ -54,6 +54,8 @@ public:
 	BaseDefenseState(Base *base, Ufo *ufo, GeoscapeState *state);
 	/// Cleans up the Base Defense state.
 	~BaseDefenseState();
+	/// Gets the attacking UFO.
+	Ufo *getUfo() const;
 	/// Handle the Timer.
 	void think();
 	/// do the next step.
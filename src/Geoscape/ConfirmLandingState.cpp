@@ -106,6 +106,15 @@ ConfirmLandingState::~ConfirmLandingState()
 
 }
 
+/**
+ * Returns the craft asking to land.
+ * @return Pointer to craft.
+ */
+Craft *ConfirmLandingState::getCraft() const
+{
+	return _craft;
+}
+
 /*
  * Make sure we aren't returning to base.
  */
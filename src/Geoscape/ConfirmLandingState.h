@@ -50,6 +50,8 @@ public:
 	~ConfirmLandingState();
 	/// initialize the state, make a sanity check.
 	void init();
+	/// Gets the landing craft.
+	Craft *getCraft() const;
 	/// Handler for clicking the Yes button.
 	void btnYesClick(Action *action);
 	/// Handler for clicking the No button.
@@ -0,0 +1,326 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GeoscapeBenchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "GeoscapeState.h"
+#include "DogfightState.h"
+#include "ConfirmLandingState.h"
+#include "BaseDefenseState.h"
+#include "Globe.h"
+#include "../Engine/Game.h"
+#include "../Engine/Screen.h"
+#include "../Engine/Options.h"
+#include "../Engine/Logger.h"
+#include "../Engine/Profiler.h"
+#include "../Engine/RNG.h"
+#include "../Mod/RuleUfo.h"
+#include "../Savegame/SavedGame.h"
+#include "../Savegame/GameTime.h"
+#include "../Savegame/Craft.h"
+#include "../Savegame/Ufo.h"
+#include "../Savegame/Base.h"
+#include "../Savegame/MissionSite.h"
+#include "../Savegame/AlienBase.h"
+#include "../Savegame/AlienMission.h"
+#include "../Savegame/Country.h"
+#include "../Savegame/Region.h"
+
+namespace OpenXcom
+{
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Gets the time passed since a point.
+ * @param start Starting point.
+ * @return Seconds passed.
+ */
+double getSeconds(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}
+
+/**
+ * Sets up a benchmark.
+ * @param game Pointer to the core game.
+ */
+GeoscapeBenchmark::GeoscapeBenchmark(Game *game) : _game(game), _geo(0), _playerTime(0.0), _playerCalls(0), _popups(0), _interceptions(0), _landings(0), _baseDefenses(0)
+{
+}
+
+/**
+ *
+ */
+GeoscapeBenchmark::~GeoscapeBenchmark()
+{
+}
+
+/**
+ * Loads the mods and a saved game, then runs its Geoscape for a number
+ * of game days, or until the game ends, and reports the times taken.
+ * The saved random seed is kept, so the same save, mods and build
+ * always play out the same way.
+ * @param filename Save file, in the user folder.
+ * @param days Number of game days.
+ * @return Program exit code.
+ */
+int GeoscapeBenchmark::run(const std::string &filename, int days)
+{
+	try
+	{
+		Log(LOG_INFO) << "Loading data...";
+		Options::updateMods();
+		_game->loadMods();
+		_game->defaultLanguage();
+		Log(LOG_INFO) << "Loading " << filename << "...";
+		Options::newSeedOnLoad = false;
+		SavedGame *save = new SavedGame();
+		_game->setSavedGame(save);
+		save->load(filename, _game->getMod());
+	}
+	catch (std::exception &e)
+	{
+		Log(LOG_ERROR) << e.what();
+		return EXIT_FAILURE;
+	}
+	SavedGame *save = _game->getSavedGame();
+	if (save->getEnding() != END_NONE || save->getSavedBattle() != 0)
+	{
+		Log(LOG_ERROR) << filename << " isn't on the Geoscape.";
+		return EXIT_FAILURE;
+	}
+
+	Options::baseXResolution = Options::baseXGeoscape;
+	Options::baseYResolution = Options::baseYGeoscape;
+	_game->getScreen()->resetDisplay(false);
+	_geo = new GeoscapeState;
+	_game->setState(_geo);
+	_geo->init();
+	play();
+
+	Log(LOG_INFO) << "Running " << days << " days...";
+	Profiler::setEnabled(true);
+	Profiler::reset();
+	for (int day = 0; day < days && save->getEnding() == END_NONE; ++day)
+	{
+		Clock::time_point dayStart = Clock::now();
+		int date = save->getTime()->getDay();
+		while (save->getTime()->getDay() == date && save->getEnding() == END_NONE)
+		{
+			// the Geoscape timer at 1 hour speed, which stops early for popups and dogfights
+			_geo->setTimeSpeed(4);
+			_geo->timeAdvance();
+			play();
+		}
+		_days.push_back(getSeconds(dayStart));
+	}
+	Profiler::setEnabled(false);
+	if (save->getEnding() != END_NONE)
+	{
+		Log(LOG_INFO) << "The game ended after " << _days.size() << " days.";
+	}
+
+	report();
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Does what the player would have to after a step: interceptions get
+ * fought, popups get closed with their default choice and landings
+ * and base defenses get won, so the Geoscape can keep going.
+ */
+void GeoscapeBenchmark::play()
+{
+	Clock::time_point start = Clock::now();
+
+	std::list<DogfightState*> dogfights = _geo->takeDogfights();
+	for (std::list<DogfightState*>::iterator i = dogfights.begin(); i != dogfights.end(); ++i)
+	{
+		intercept((*i)->getCraft(), (*i)->getUfo());
+		delete *i;
+	}
+
+	while (State *popup = _geo->takePopup())
+	{
+		if (ConfirmLandingState *landing = dynamic_cast<ConfirmLandingState*>(popup))
+		{
+			land(landing->getCraft());
+		}
+		else if (BaseDefenseState *defense = dynamic_cast<BaseDefenseState*>(popup))
+		{
+			// the base defenses always shoot it down
+			defense->getUfo()->setStatus(Ufo::DESTROYED);
+			_baseDefenses++;
+		}
+		delete popup;
+		_popups++;
+	}
+
+	// a base with no defenses was attacked, the soldiers always win
+	if (_game->getSavedGame()->getSavedBattle() != 0)
+	{
+		_game->getSavedGame()->setBattleGame(0);
+		_baseDefenses++;
+	}
+
+	// close anything the Geoscape opened by itself
+	while (!_game->isState(_geo))
+	{
+		_game->popState();
+	}
+
+	_playerTime += getSeconds(start);
+	_playerCalls++;
+}
+
+/**
+ * Settles an interception: a craft with weapons always brings
+ * the UFO down, scoring as in a dogfight but without any
+ * retaliation, and a craft without them goes home.
+ * @param craft Intercepting craft.
+ * @param ufo Intercepted UFO.
+ */
+void GeoscapeBenchmark::intercept(Craft *craft, Ufo *ufo)
+{
+	_interceptions++;
+	craft->setInDogfight(false);
+	ufo->setShootingAt(0);
+	if (ufo->getStatus() != Ufo::FLYING || craft->getNumWeapons() == 0)
+	{
+		craft->returnToBase();
+		return;
+	}
+
+	SavedGame *save = _game->getSavedGame();
+	ufo->setShotDownByCraftId(craft->getUniqueId());
+	ufo->setDamage(ufo->getCraftStats().damageMax / 2);
+	ufo->getMission()->ufoShotDown(*ufo);
+	int score = ufo->getRules()->getScore() * (ufo->isDestroyed() ? 2 : 1);
+	if (Country *country = save->locateCountry(*ufo))
+	{
+		country->addActivityXcom(score);
+	}
+	if (Region *region = save->locateRegion(*ufo))
+	{
+		region->addActivityXcom(score);
+	}
+	if (ufo->isDestroyed())
+		return;
+
+	if (!_geo->getGlobe()->insideLand(ufo->getLongitude(), ufo->getLatitude()))
+	{
+		ufo->setStatus(Ufo::DESTROYED);
+	}
+	else
+	{
+		ufo->setSecondsRemaining(RNG::generate(24, 96) * 3600);
+		ufo->setAltitude("STR_GROUND");
+		if (ufo->getCrashId() == 0)
+		{
+			ufo->setCrashId(save->getId("STR_CRASH_SITE"));
+		}
+	}
+}
+
+/**
+ * Settles a ground mission: the soldiers always clear UFO sites and
+ * mission sites, which go away without any loot, while alien base
+ * assaults are called off.
+ * @param craft Landing craft.
+ */
+void GeoscapeBenchmark::land(Craft *craft)
+{
+	SavedGame *save = _game->getSavedGame();
+	Target *target = craft->getDestination();
+	if (Ufo *ufo = dynamic_cast<Ufo*>(target))
+	{
+		ufo->setStatus(Ufo::DESTROYED);
+		craft->returnToBase();
+		_landings++;
+	}
+	else if (MissionSite *site = dynamic_cast<MissionSite*>(target))
+	{
+		// deleting the site sends everyone after it home
+		std::vector<MissionSite*>::iterator i = std::find(save->getMissionSites()->begin(), save->getMissionSites()->end(), site);
+		if (i != save->getMissionSites()->end())
+		{
+			save->getMissionSites()->erase(i);
+			delete site;
+		}
+		_landings++;
+	}
+	else if (dynamic_cast<AlienBase*>(target))
+	{
+		craft->returnToBase();
+	}
+}
+
+/**
+ * Writes the time taken per game day and per section of the game logic.
+ */
+void GeoscapeBenchmark::report() const
+{
+	double total = 0.0;
+	for (std::vector<double>::const_iterator i = _days.begin(); i != _days.end(); ++i)
+	{
+		total += *i;
+	}
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "Ran " << _days.size() << " game days in " << total << " s" << std::endl;
+	if (!_days.empty())
+	{
+		ss << "Per day: average " << total * 1000 / _days.size() << " ms, fastest "
+			<< *std::min_element(_days.begin(), _days.end()) * 1000 << " ms, slowest "
+			<< *std::max_element(_days.begin(), _days.end()) * 1000 << " ms" << std::endl;
+	}
+	ss << std::endl;
+	for (size_t i = 0; i < _days.size(); ++i)
+	{
+		ss << "Day " << std::setw(4) << i + 1 << ": " << std::setw(12) << _days[i] * 1000 << " ms" << std::endl;
+	}
+	ss << std::endl;
+	ss << std::left << std::setw(14) << "Section" << std::right << std::setw(10) << "Calls" << std::setw(14) << "Total ms" << std::setw(14) << "ms/call" << std::setw(10) << "Share" << std::endl;
+	for (int i = Profiler::PROFILE_GEOSCAPE_FIRST; i <= Profiler::PROFILE_COUNT; ++i)
+	{
+		// the player's part comes last, after the sections of the game logic
+		const char *name = i < Profiler::PROFILE_COUNT ? Profiler::getName((Profiler::Section)i) : "player";
+		double time = i < Profiler::PROFILE_COUNT ? Profiler::getTime((Profiler::Section)i) : _playerTime;
+		int calls = i < Profiler::PROFILE_COUNT ? Profiler::getCalls((Profiler::Section)i) : _playerCalls;
+		ss << std::left << std::setw(14) << name << std::right << std::setw(10) << calls
+			<< std::setw(14) << time * 1000
+			<< std::setw(14) << (calls ? time * 1000 / calls : 0.0)
+			<< std::setw(9) << (total > 0.0 ? time * 100 / total : 0.0) << "%" << std::endl;
+	}
+	ss << std::endl;
+	ss << "Popups closed: " << _popups << ", interceptions: " << _interceptions << ", landings: " << _landings << ", base defenses: " << _baseDefenses << std::endl;
+	std::cout << ss.str();
+}
+
+}
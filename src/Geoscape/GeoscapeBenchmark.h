@@ -0,0 +1,65 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string>
+#include <vector>
+
+namespace OpenXcom
+{
+
+class Game;
+class GeoscapeState;
+class Craft;
+class Ufo;
+
+/**
+ * Runs the Geoscape of a saved game without a window or a player,
+ * to measure how fast the strategic game logic goes for a given save
+ * and set of mods. Popups are closed as soon as they come up and
+ * fights are settled on the spot by a simple model, then the time
+ * taken by each game day and each time trigger gets reported.
+ */
+class GeoscapeBenchmark
+{
+private:
+	Game *_game;
+	GeoscapeState *_geo;
+	double _playerTime;
+	int _playerCalls;
+	std::vector<double> _days;
+	int _popups, _interceptions, _landings, _baseDefenses;
+
+	/// Plays the player's part after a step.
+	void play();
+	/// Settles an interception.
+	void intercept(Craft *craft, Ufo *ufo);
+	/// Settles a ground mission.
+	void land(Craft *craft);
+	/// Reports the results.
+	void report() const;
+public:
+	/// Creates a benchmark for a game.
+	GeoscapeBenchmark(Game *game);
+	/// Cleans up the benchmark.
+	~GeoscapeBenchmark();
+	/// Runs a save for a number of days.
+	int run(const std::string &filename, int days);
+};
+
+}
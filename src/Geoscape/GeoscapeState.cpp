@@ -34,6 +34,7 @@
 #include "../Interface/Text.h"
 #include "../Interface/TextButton.h"
 #include "../Engine/Timer.h"
+#include "../Engine/Profiler.h"
 #include "../Savegame/GameTime.h"
 #include "../Savegame/SavedGame.h"
 #include "../Savegame/Base.h"
@@ -48,6 +49,7 @@
 #include "../Savegame/Transfer.h"
 #include "../Savegame/Soldier.h"
 #include "../Savegame/SoldierDiary.h"
+#include "../Savegame/SphereGrid.h"
 #include "../Menu/PauseState.h"
 #include "InterceptState.h"
 #include "../Basescape/BasescapeState.h"
@@ -659,6 +661,14 @@ void GeoscapeState::timeAdvance()
 
 	for (int i = 0; i < timeSpan && !_pause; ++i)
 	{
+		// jump over stretches where time5Seconds() would only count down landed UFOs and fly straight on
+		int quietSteps = getQuietSteps(timeSpan - i);
+		if (quietSteps > 0)
+		{
+			skipQuietSteps(quietSteps);
+			i += quietSteps - 1;
+			continue;
+		}
 		TimeTrigger trigger;
 		trigger = _game->getSavedGame()->getTime()->advance();
 		switch (trigger)
@@ -684,12 +694,114 @@ void GeoscapeState::timeAdvance()
 	_globe->draw();
 }
 
+/**
+ * Gets how many of the next 5 second steps can be skipped at once,
+ * because nothing in them can meet anything else: no dogfights, no craft
+ * chasing a UFO and nobody chasing a flying UFO. Then time5Seconds() does
+ * nothing but count down landed UFOs and fly everything else straight
+ * towards places that stay put, which MovingTarget::moveSteps() does in
+ * one go. The skip ends before anything arrives or lifts off, and before
+ * the next 10 minute trigger, as that runs the detection and mission logic.
+ * @param maxSteps Most steps to skip.
+ * @return Number of steps that can be skipped, 0 if the next one has to run.
+ */
+int GeoscapeState::getQuietSteps(int maxSteps)
+{
+	SavedGame *save = _game->getSavedGame();
+	int steps = std::min(maxSteps, save->getTime()->getStepsToNextTrigger() - 1);
+	if (steps <= 0 || save->getBases()->empty() || save->getEnding() == END_LOSE ||
+		!_dogfights.empty() || !_dogfightsToBeStarted.empty())
+	{
+		return 0;
+	}
+	for (std::vector<Waypoint*>::const_iterator i = save->getWaypoints()->begin(); i != save->getWaypoints()->end(); ++i)
+	{
+		// unused waypoints get cleaned up by the next step
+		if ((*i)->getFollowers()->empty())
+		{
+			return 0;
+		}
+	}
+	for (std::vector<Ufo*>::const_iterator i = save->getUfos()->begin(); i != save->getUfos()->end(); ++i)
+	{
+		if ((*i)->getStatus() == Ufo::LANDED)
+		{
+			// stop before the step that lifts it off
+			steps = std::min(steps, (int)(*i)->getSecondsRemaining() / 5 - 1);
+		}
+		else if ((*i)->getStatus() == Ufo::FLYING && (*i)->getFollowers()->empty() &&
+			(*i)->getDestination() && !dynamic_cast<MovingTarget*>((*i)->getDestination()))
+		{
+			// stop before the step that reaches the waypoint
+			steps = std::min(steps, (*i)->getStepsToDestination() - 1);
+		}
+		else if ((*i)->getStatus() != Ufo::CRASHED || !(*i)->getDetected())
+		{
+			return 0;
+		}
+	}
+	for (std::vector<Base*>::const_iterator i = save->getBases()->begin(); i != save->getBases()->end(); ++i)
+	{
+		for (std::vector<Craft*>::const_iterator j = (*i)->getCrafts()->begin(); j != (*i)->getCrafts()->end(); ++j)
+		{
+			if ((*j)->isDestroyed() || (*j)->isInDogfight() || (*j)->isTakingOff())
+			{
+				return 0;
+			}
+			if ((*j)->getDestination() != 0)
+			{
+				if (dynamic_cast<MovingTarget*>((*j)->getDestination()))
+				{
+					return 0;
+				}
+				steps = std::min(steps, (*j)->getStepsToDestination() - 1);
+			}
+		}
+	}
+	return std::max(steps, 0);
+}
+
+/**
+ * Runs a stretch of 5 second steps found by getQuietSteps() in one go:
+ * landed UFOs count down and everything else flies straight on.
+ * @param steps Number of steps to skip.
+ */
+void GeoscapeState::skipQuietSteps(int steps)
+{
+	Profiler profile(Profiler::PROFILE_QUIET);
+
+	for (std::vector<Ufo*>::iterator u = _game->getSavedGame()->getUfos()->begin(); u != _game->getSavedGame()->getUfos()->end(); ++u)
+	{
+		if ((*u)->getStatus() == Ufo::LANDED)
+		{
+			(*u)->setSecondsRemaining((*u)->getSecondsRemaining() - steps * 5);
+		}
+		else if ((*u)->getStatus() == Ufo::FLYING)
+		{
+			(*u)->moveSteps(steps);
+		}
+	}
+	for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); b != _game->getSavedGame()->getBases()->end(); ++b)
+	{
+		for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); c != (*b)->getCrafts()->end(); ++c)
+		{
+			if ((*c)->getDestination() != 0)
+			{
+				(*c)->moveSteps(steps);
+			}
+		}
+	}
+	_game->getSavedGame()->getTime()->skipSteps(steps);
+}
+
 /**
  * Takes care of any game logic that has to
  * run every game second, like craft movement.
  */
 void GeoscapeState::time5Seconds()
 {
+	Profiler profile(Profiler::PROFILE_5SEC);
+
 	// Game over if there are no more bases.
 	if (_game->getSavedGame()->getBases()->empty())
 	{
@@ -784,21 +896,13 @@ void GeoscapeState::time5Seconds()
 		{
 			if ((*j)->isDestroyed())
 			{
-				for (std::vector<Country*>::iterator country = _game->getSavedGame()->getCountries()->begin(); country != _game->getSavedGame()->getCountries()->end(); ++country)
+				if (Country *country = _game->getSavedGame()->locateCountry((*j)->getLongitude(), (*j)->getLatitude()))
 				{
-					if ((*country)->getRules()->insideCountry((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*country)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					country->addActivityXcom(-(*j)->getRules()->getScore());
 				}
-				for (std::vector<Region*>::iterator region = _game->getSavedGame()->getRegions()->begin(); region != _game->getSavedGame()->getRegions()->end(); ++region)
+				if (Region *region = _game->getSavedGame()->locateRegion((*j)->getLongitude(), (*j)->getLatitude()))
 				{
-					if ((*region)->getRules()->insideRegion((*j)->getLongitude(), (*j)->getLatitude()))
-					{
-						(*region)->addActivityXcom(-(*j)->getRules()->getScore());
-						break;
-					}
+					region->addActivityXcom(-(*j)->getRules()->getScore());
 				}
 				// if a transport craft has been shot down, kill all the soldiers on board.
 				if ((*j)->getRules()->getSoldiers() > 0)
@@ -1060,6 +1164,8 @@ struct SetRetaliationTarget: public std::unary_function<std::map<const Region *,
  */
 void GeoscapeState::time10Minutes()
 {
+	Profiler profile(Profiler::PROFILE_10MIN);
+
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
 		// Fuel consumption for XCOM craft.
@@ -1167,13 +1273,9 @@ bool GeoscapeState::processMissionSite(MissionSite *site) const
 	{
 		region->addActivityAlien(score);
 	}
-	for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+	if (Country *country = _game->getSavedGame()->locateCountry(site->getLongitude(), site->getLatitude()))
 	{
-		if ((*k)->getRules()->insideCountry(site->getLongitude(), site->getLatitude()))
-		{
-			(*k)->addActivityAlien(score);
-			break;
-		}
+		country->addActivityAlien(score);
 	}
 	if (!removeSite)
 	{
@@ -1210,6 +1312,8 @@ struct expireCrashedUfo: public std::unary_function<Ufo*, void>
  */
 void GeoscapeState::time30Minutes()
 {
+	Profiler profile(Profiler::PROFILE_30MIN);
+
 	// Decrease mission countdowns
 	std::for_each(_game->getSavedGame()->getAlienMissions().begin(),
 			  _game->getSavedGame()->getAlienMissions().end(),
@@ -1276,6 +1380,28 @@ void GeoscapeState::time30Minutes()
 		}
 	}
 
+	// Gather the radars, bases followed by their crafts out on the globe,
+	// so each UFO only has to check the ones that can reach it
+	std::vector<Base*> radarBases;
+	std::vector<Craft*> radarCrafts;
+	SphereGrid radarGrid;
+	const double nauticalMile = (1 / 60.0) * (M_PI / 180);
+	for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); b != _game->getSavedGame()->getBases()->end(); ++b)
+	{
+		radarGrid.add(radarBases.size(), (*b)->getLongitude(), (*b)->getLatitude(), (*b)->getMaxRadarRange() * nauticalMile);
+		radarBases.push_back(*b);
+		radarCrafts.push_back(0);
+		for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); c != (*b)->getCrafts()->end(); ++c)
+		{
+			if ((*c)->getStatus() == "STR_OUT")
+			{
+				radarGrid.add(radarBases.size(), (*c)->getLongitude(), (*c)->getLatitude(), (*c)->getCraftStats().radarRange * nauticalMile);
+				radarBases.push_back(*b);
+				radarCrafts.push_back(*c);
+			}
+		}
+	}
+
 	// Handle UFO detection and give aliens points
 	for (std::vector<Ufo*>::iterator u = _game->getSavedGame()->getUfos()->begin(); u != _game->getSavedGame()->getUfos()->end(); ++u)
 	{
@@ -1286,44 +1412,36 @@ void GeoscapeState::time30Minutes()
 			points *= 2;
 		case Ufo::FLYING:
 			// Get area
-			for (std::vector<Region*>::iterator k = _game->getSavedGame()->getRegions()->begin(); k != _game->getSavedGame()->getRegions()->end(); ++k)
+			if (Region *region = _game->getSavedGame()->locateRegion((*u)->getLongitude(), (*u)->getLatitude()))
 			{
-				if ((*k)->getRules()->insideRegion((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				region->addActivityAlien(points);
 			}
 			// Get country
-			for (std::vector<Country*>::iterator k = _game->getSavedGame()->getCountries()->begin(); k != _game->getSavedGame()->getCountries()->end(); ++k)
+			if (Country *country = _game->getSavedGame()->locateCountry((*u)->getLongitude(), (*u)->getLatitude()))
 			{
-				if ((*k)->getRules()->insideCountry((*u)->getLongitude(), (*u)->getLatitude()))
-				{
-					(*k)->addActivityAlien(points);
-					break;
-				}
+				country->addActivityAlien(points);
 			}
 			if (!(*u)->getDetected())
 			{
 				bool detected = false, hyperdetected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); !hyperdetected && b != _game->getSavedGame()->getBases()->end(); ++b)
+				const std::vector<int> &radars = radarGrid.get((*u)->getLongitude(), (*u)->getLatitude());
+				for (std::vector<int>::const_iterator r = radars.begin(); !hyperdetected && r != radars.end(); ++r)
 				{
-					switch ((*b)->detect(*u))
-					{
-					case 2:	// hyper-wave decoder
-						(*u)->setHyperDetected(true);
-						hyperdetected = true;
-					case 1: // conventional radar
-						detected = true;
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
+					if (radarCrafts[*r] == 0)
 					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->detect(*u))
+						switch (radarBases[*r]->detect(*u))
 						{
+						case 2:	// hyper-wave decoder
+							(*u)->setHyperDetected(true);
+							hyperdetected = true;
+						case 1: // conventional radar
 							detected = true;
-							break;
 						}
 					}
+					else if (!detected && radarCrafts[*r]->detect(*u))
+					{
+						detected = true;
+					}
 				}
 				if (detected)
 				{
@@ -1334,28 +1452,28 @@ void GeoscapeState::time30Minutes()
 			else
 			{
 				bool detected = false, hyperdetected = false;
-				for (std::vector<Base*>::iterator b = _game->getSavedGame()->getBases()->begin(); !hyperdetected && b != _game->getSavedGame()->getBases()->end(); ++b)
+				const std::vector<int> &radars = radarGrid.get((*u)->getLongitude(), (*u)->getLatitude());
+				for (std::vector<int>::const_iterator r = radars.begin(); !hyperdetected && r != radars.end(); ++r)
 				{
-					switch ((*b)->insideRadarRange(*u))
-					{
-					case 2:	// hyper-wave decoder
-						detected = true;
-						hyperdetected = true;
-						(*u)->setHyperDetected(true);
-						break;
-					case 1: // conventional radar
-						detected = true;
-						hyperdetected = (*u)->getHyperDetected();
-					}
-					for (std::vector<Craft*>::iterator c = (*b)->getCrafts()->begin(); !detected && c != (*b)->getCrafts()->end(); ++c)
+					if (radarCrafts[*r] == 0)
 					{
-						if ((*c)->getStatus() == "STR_OUT" && (*c)->insideRadarRange(*u))
+						switch (radarBases[*r]->insideRadarRange(*u))
 						{
+						case 2:	// hyper-wave decoder
 							detected = true;
-							hyperdetected = (*u)->getHyperDetected();
+							hyperdetected = true;
+							(*u)->setHyperDetected(true);
 							break;
+						case 1: // conventional radar
+							detected = true;
+							hyperdetected = (*u)->getHyperDetected();
 						}
 					}
+					else if (!detected && radarCrafts[*r]->insideRadarRange(*u))
+					{
+						detected = true;
+						hyperdetected = (*u)->getHyperDetected();
+					}
 				}
 				if (!detected)
 				{
@@ -1394,6 +1512,8 @@ void GeoscapeState::time30Minutes()
  */
 void GeoscapeState::time1Hour()
 {
+	Profiler profile(Profiler::PROFILE_1HOUR);
+
 	// Handle craft maintenance
 	for (std::vector<Base*>::iterator i = _game->getSavedGame()->getBases()->begin(); i != _game->getSavedGame()->getBases()->end(); ++i)
 	{
@@ -1519,6 +1639,8 @@ void GenerateSupplyMission::operator()(const AlienBase *base) const
  */
 void GeoscapeState::time1Day()
 {
+	Profiler profile(Profiler::PROFILE_1DAY);
+
 	SavedGame *saveGame = _game->getSavedGame();
 	Mod *mod = _game->getMod();
 	for (Base *base : *_game->getSavedGame()->getBases())
@@ -1698,21 +1820,13 @@ void GeoscapeState::time1Day()
 	// handle regional and country points for alien bases
 	for (std::vector<AlienBase*>::const_iterator b = saveGame->getAlienBases()->begin(); b != saveGame->getAlienBases()->end(); ++b)
 	{
-		for (std::vector<Region*>::iterator k = saveGame->getRegions()->begin(); k != saveGame->getRegions()->end(); ++k)
+		if (Region *region = saveGame->locateRegion((*b)->getLongitude(), (*b)->getLatitude()))
 		{
-			if ((*k)->getRules()->insideRegion((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			region->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
-		for (std::vector<Country*>::iterator k = saveGame->getCountries()->begin(); k != saveGame->getCountries()->end(); ++k)
+		if (Country *country = saveGame->locateCountry((*b)->getLongitude(), (*b)->getLatitude()))
 		{
-			if ((*k)->getRules()->insideCountry((*b)->getLongitude(), (*b)->getLatitude()))
-			{
-				(*k)->addActivityAlien((*b)->getDeployment()->getPoints());
-				break;
-			}
+			country->addActivityAlien((*b)->getDeployment()->getPoints());
 		}
 	}
 
@@ -1741,6 +1855,8 @@ void GeoscapeState::time1Day()
  */
 void GeoscapeState::time1Month()
 {
+	Profiler profile(Profiler::PROFILE_1MONTH);
+
 	_game->getSavedGame()->addMonth();
 
 	// Determine alien mission for this month.
@@ -1809,6 +1925,52 @@ void GeoscapeState::popup(State *state)
 	_popups.push_back(state);
 }
 
+/**
+ * Takes the next popup window off the queue without showing it,
+ * for running the Geoscape without a player.
+ * @return Pointer to popup state, or 0 if there are none.
+ */
+State *GeoscapeState::takePopup()
+{
+	if (_popups.empty())
+		return 0;
+
+	State *state = _popups.front();
+	_popups.pop_front();
+	return state;
+}
+
+/**
+ * Takes all the dogfights off the Geoscape, the running ones and
+ * the ones waiting to start, for settling them without the dogfight
+ * screens. With no dogfights left, the game timer can go on.
+ * @return Dogfights taken, which the caller has to delete.
+ */
+std::list<DogfightState*> GeoscapeState::takeDogfights()
+{
+	std::list<DogfightState*> dogfights;
+	dogfights.splice(dogfights.end(), _dogfightsToBeStarted);
+	dogfights.splice(dogfights.end(), _dogfights);
+	_minimizedDogfights = 0;
+	_dogfightStartTimer->stop();
+	_dogfightTimer->stop();
+	_pause = false;
+	return dogfights;
+}
+
+/**
+ * Sets the timer speed, as if the player had pressed its button.
+ * @param speed Speed from 0 (5 seconds) to 5 (1 day).
+ */
+void GeoscapeState::setTimeSpeed(int speed)
+{
+	TextButton *buttons[] = { _btn5Secs, _btn1Min, _btn5Mins, _btn30Mins, _btn1Hour, _btn1Day };
+	SDL_Event ev;
+	ev.button.button = SDL_BUTTON_LEFT;
+	Action act(&ev, _game->getScreen()->getXScale(), _game->getScreen()->getYScale(), _game->getScreen()->getCursorTopBlackBand(), _game->getScreen()->getCursorLeftBlackBand());
+	buttons[std::max(0, std::min(speed, 5))]->mousePress(&act, this);
+}
+
 /**
  * Returns a pointer to the Geoscape globe for
  * access by other substates.
@@ -87,6 +87,12 @@ public:
 	void timerReset();
 	/// Displays a popup window.
 	void popup(State *state);
+	/// Takes the next popup window off the queue.
+	State *takePopup();
+	/// Takes all the dogfights off the Geoscape.
+	std::list<DogfightState*> takeDogfights();
+	/// Sets the timer speed.
+	void setTimeSpeed(int speed);
 	/// Gets the Geoscape globe.
 	Globe *getGlobe() const;
 	/// Handler for clicking the globe.
@@ -150,6 +156,10 @@ public:
 	/// Update the resolution settings, we just resized the window.
 	void resize(int &dX, int &dY);
 private:
+	/// Gets how many of the next 5 second steps nothing moves in.
+	int getQuietSteps(int maxSteps);
+	/// Skips over steps nothing moves in.
+	void skipQuietSteps(int steps);
 	/// Handle alien mission generation.
 	void determineAlienMissions();
 	/// Process each individual mission script command.
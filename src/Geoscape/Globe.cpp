@@ -43,6 +43,7 @@
 #include "../Savegame/Waypoint.h"
 #include "../Engine/ShaderMove.h"
 #include "../Engine/ShaderRepeat.h"
+#include "../Engine/ShaderDrawSimd.h"
 #include "../Engine/Options.h"
 #include "../Savegame/MissionSite.h"
 #include "../Savegame/AlienBase.h"
@@ -172,7 +173,7 @@ struct Ocean
 
 struct CreateShadow
 {
-	static inline Uint8 getShadowValue(const Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	static inline Uint8 getShadowValue(const Cord& earth, const Cord& sun, const Sint16& noise)
 	{
 		Cord temp = earth;
 		//diff
@@ -198,48 +199,91 @@ struct CreateShadow
 
 		if (temp.x > 0.)
 		{
-			const Sint16 val = (temp.x> 31)? 31 : (Sint16)temp.x;
-			const int d = dest & helper::ColorGroup;
-			if (d ==  Globe::OCEAN_COLOR || d == Globe::OCEAN_COLOR + 16)
-			{
-				//this pixel is ocean
-				return Globe::OCEAN_COLOR + val;
-			}
-			else
-			{
-				//this pixel is land
-				if (dest==0) return val;
-				const int s = val / 3;
-				const int e = dest+s;
-				if (e > d + helper::ColorShade)
-					return d + helper::ColorShade;
-				return e;
-			}
+			return (temp.x> 31)? 31 : (Sint16)temp.x;
+		}
+		return 0;
+	}
+
+	static inline void func(Uint8& oceanShade, Uint8& landShade, const Cord& earth, const Cord& sun, const Sint16& noise)
+	{
+		if (earth.z)
+		{
+			oceanShade = getShadowValue(earth, sun, noise);
+			landShade = oceanShade / 3;
 		}
 		else
 		{
-			const int d = dest & helper::ColorGroup;
-			if (d ==  Globe::OCEAN_COLOR || d ==  Globe::OCEAN_COLOR + 16)
-			{
-				//this pixel is ocean
-				return Globe::OCEAN_COLOR;
-			}
-			else
+			oceanShade = 0;
+			landShade = helper::ShadeRow::ShadowOutside;
+		}
+	}
+};
+
+/**
+ * Gets the lon/lat bounding box of a polygon. It follows the edges as
+ * great circles, and covers the whole pole for polygons around one.
+ * @param poly Polygon to measure.
+ * @param minLon Output west edge, in radians. The longitudes are unwrapped
+ * from the first point, so minLon <= maxLon but either may be out of 0..2pi.
+ * @param maxLon Output east edge, in radians.
+ * @param minLat Output minimum latitude, in radians.
+ * @param maxLat Output maximum latitude, in radians.
+ * @return False if the polygon winds around a pole, so all longitudes count.
+ */
+bool getPolygonBounds(const Polygon *poly, double &minLon, double &maxLon, double &minLat, double &maxLat)
+{
+	const int edgeSamples = 8;
+	const int points = poly->getPoints();
+	const double startLon = poly->getLongitude(0);
+	double prevLon = startLon, unwrapped = 0.0;
+	minLat = M_PI_2;
+	maxLat = -M_PI_2;
+	minLon = 0.0;
+	maxLon = 0.0;
+	for (int j = 0; j < points; ++j)
+	{
+		int k = (j + 1) % points;
+		double lat1 = poly->getLatitude(j), lon1 = poly->getLongitude(j);
+		double lat2 = poly->getLatitude(k), lon2 = poly->getLongitude(k);
+		double x1 = cos(lat1) * cos(lon1), y1 = cos(lat1) * sin(lon1), z1 = sin(lat1);
+		double x2 = cos(lat2) * cos(lon2), y2 = cos(lat2) * sin(lon2), z2 = sin(lat2);
+		for (int s = 0; s < edgeSamples; ++s)
+		{
+			// normalized lerp between the points stays on their great circle
+			double t = (double)s / edgeSamples;
+			double x = x1 + (x2 - x1) * t, y = y1 + (y2 - y1) * t, z = z1 + (z2 - z1) * t;
+			double len = sqrt(x * x + y * y + z * z);
+			if (len < 1e-9)
 			{
-				//this pixel is land
-				return dest;
+				continue;
 			}
+			double lat = asin(Clamp(z / len, -1.0, 1.0));
+			double lon = atan2(y, x);
+			double step = lon - prevLon;
+			step -= 2 * M_PI * floor((step + M_PI) / (2 * M_PI));
+			unwrapped += step;
+			prevLon = lon;
+			minLat = std::min(minLat, lat);
+			maxLat = std::max(maxLat, lat);
+			minLon = std::min(minLon, unwrapped);
+			maxLon = std::max(maxLon, unwrapped);
 		}
 	}
-
-	static inline void func(Uint8& dest, const Cord& earth, const Cord& sun, const Sint16& noise)
+	double step = startLon - prevLon;
+	step -= 2 * M_PI * floor((step + M_PI) / (2 * M_PI));
+	unwrapped += step;
+	minLon += startLon;
+	maxLon += startLon;
+	if (std::abs(unwrapped) > M_PI)
 	{
-		if (dest && earth.z)
-			dest = getShadowValue(dest, earth, sun, noise);
+		if (minLat + maxLat > 0)
+			maxLat = M_PI_2;
 		else
-			dest = 0;
+			minLat = -M_PI_2;
+		return false;
 	}
-};
+	return true;
+}
 
 }//namespace
 
@@ -254,8 +298,8 @@ struct CreateShadow
  * @param x X position in pixels.
  * @param y Y position in pixels.
  */
-Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _hover(false), _blink(-1),
-																					_isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
+Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y) : InteractiveSurface(width, height, x, y), _rotLon(0.0), _rotLat(0.0), _hoverLon(0.0), _hoverLat(0.0), _cenX(cenX), _cenY(cenY), _game(game), _hover(false), _blink(-1), _cacheLandDirty(true),
+																					_landCellCenLat(0.0), _landCellRadius(0.0), _landCellCenX(0), _landCellCenY(0), _landCellWidth(0), _shadowZoom(0), _shadowCenX(0), _shadowCenY(0), _labelCenLon(0.0), _labelCenLat(0.0), _labelRadius(0.0), _labelCenX(0), _labelCenY(0), _isMouseScrolling(false), _isMouseScrolled(false), _xBeforeMouseScrolling(0), _yBeforeMouseScrolling(0), _lonBeforeMouseScrolling(0.0), _latBeforeMouseScrolling(0.0), _mouseScrollingStartTime(0), _totalMouseMoveX(0), _totalMouseMoveY(0), _mouseMovedOverThreshold(false)
 {
 	_rules = game->getMod()->getGlobe();
 	_texture = new SurfaceSet(*_game->getMod()->getSurfaceSet("TEXTURE.DAT"));
@@ -286,7 +330,7 @@ Globe::Globe(Game* game, int cenX, int cenY, int width, int height, int x, int y
 	for (size_t i=0; i<_randomNoiseData.size(); ++i)
 		_randomNoiseData[i] = rand()%4;
 
-	cachePolygons();
+	buildPolygonIndex();
 }
 
 /**
@@ -301,6 +345,7 @@ Globe::~Globe()
 	delete _texture;
 	delete _radars;
 	delete _clipper;
+	clearLabels();
 
 	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
 	{
@@ -393,13 +438,86 @@ double Globe::lastVisibleLat(double lon) const
 }
 
 
+/**
+ * Gets which cell of the polygon index covers a point.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return Cell index.
+ */
+int Globe::getPolygonIndexCell(double lon, double lat) const
+{
+	int x = (int)floor(lon * POLYGON_INDEX_LON / (2 * M_PI)) % POLYGON_INDEX_LON;
+	int y = (int)floor((lat + M_PI_2) * POLYGON_INDEX_LAT / M_PI);
+	if (x < 0) x += POLYGON_INDEX_LON;
+	y = Clamp(y, 0, POLYGON_INDEX_LAT - 1);
+	return y * POLYGON_INDEX_LON + x;
+}
+
+/**
+ * Sorts the land polygons into a grid of lon/lat cells, so looking up
+ * the polygon under a point only has to test the few polygons of its cell
+ * instead of the whole globe. Each polygon goes into every cell its
+ * bounding box touches, plus a cell of margin, as its edges bend away
+ * from the lines between its points.
+ */
+void Globe::buildPolygonIndex()
+{
+	const double cellLon = 2 * M_PI / POLYGON_INDEX_LON;
+	const double cellLat = M_PI / POLYGON_INDEX_LAT;
+
+	_polygonIndex.clear();
+	_polygonIndex.resize(POLYGON_INDEX_LON * POLYGON_INDEX_LAT);
+	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
+	{
+		if ((*i)->getPoints() == 0)
+		{
+			continue;
+		}
+		double minLon, maxLon, minLat, maxLat;
+		bool fullLon = !getPolygonBounds(*i, minLon, maxLon, minLat, maxLat) || maxLon - minLon >= 2 * M_PI - cellLon;
+		int y1 = Clamp((int)floor((minLat + M_PI_2) / cellLat) - 1, 0, POLYGON_INDEX_LAT - 1);
+		int y2 = Clamp((int)floor((maxLat + M_PI_2) / cellLat) + 1, 0, POLYGON_INDEX_LAT - 1);
+		int x1 = 0, x2 = POLYGON_INDEX_LON - 1;
+		if (!fullLon)
+		{
+			// cells get narrower towards the poles, so widen the margin there
+			double nearPole = std::max(std::abs(minLat), std::abs(maxLat)) + cellLat;
+			int margin = (int)ceil(1.0 / std::max(cos(nearPole), 1e-3));
+			x1 = (int)floor(minLon / cellLon) - margin;
+			x2 = (int)floor(maxLon / cellLon) + margin;
+			if (x2 - x1 >= POLYGON_INDEX_LON)
+			{
+				x1 = 0;
+				x2 = POLYGON_INDEX_LON - 1;
+			}
+		}
+		for (int y = y1; y <= y2; ++y)
+		{
+			for (int x = x1; x <= x2; ++x)
+			{
+				int cellX = x % POLYGON_INDEX_LON;
+				if (cellX < 0) cellX += POLYGON_INDEX_LON;
+				_polygonIndex[y * POLYGON_INDEX_LON + cellX].push_back(*i);
+			}
+		}
+	}
+}
+
+/**
+ * Gets the land polygon under a point, only testing the polygons
+ * of its cell in the polygon index.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @return Pointer to the polygon, or NULL over water.
+ */
 Polygon* Globe::getPolygonFromLonLat(double lon, double lat) const
 {
 	const double zDiscard=0.75f;
 	double coslat = cos(lat);
 	double sinlat = sin(lat);
 
-	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
+	const std::vector<Polygon*> &candidates = _polygonIndex[getPolygonIndexCell(lon, lat)];
+	for (std::vector<Polygon*>::const_iterator i = candidates.begin(); i != candidates.end(); ++i)
 	{
 		double x, y, z, x2, y2;
 		double clat, clon;
@@ -829,6 +947,8 @@ void Globe::setPalette(SDL_Color *colors, int firstcolor, int ncolors)
 	_countries->setPalette(colors, firstcolor, ncolors);
 	_markers->setPalette(colors, firstcolor, ncolors);
 	_radars->setPalette(colors, firstcolor, ncolors);
+
+	clearLabels();
 }
 
 /**
@@ -871,7 +991,7 @@ void Globe::draw()
 {
 	if (_redraw)
 	{
-		cachePolygons();
+		_cacheLandDirty = true;
 	}
 	Surface::draw();
 	drawOcean();
@@ -901,11 +1021,26 @@ void Globe::drawOcean()
 /**
  * Renders the land, taking all the visible world polygons
  * and texturing and shading them accordingly.
+ * Unless the globe is zoomed in too close for it, this samples
+ * the land raster instead of drawing the polygons one by one.
  */
 void Globe::drawLand()
 {
+	int width;
+	const std::vector<Uint8> *raster = getLandRaster(&width);
+	if (raster)
+	{
+		drawLandRaster(*raster, width);
+		return;
+	}
+
 	Sint16 x[4], y[4];
 
+	if (_cacheLandDirty)
+	{
+		cachePolygons();
+		_cacheLandDirty = false;
+	}
 	for (std::list<Polygon*>::iterator i = _cacheLand.begin(); i != _cacheLand.end(); ++i)
 	{
 		// Convert coordinates
@@ -920,6 +1055,229 @@ void Globe::drawLand()
 	}
 }
 
+/**
+ * Gets the land raster of the current zoom level, making it on first use.
+ * The raster is an equirectangular map of which texture the land polygons
+ * put where, with cells about as wide as a pixel in the middle of the globe.
+ * Later polygons cover earlier ones, same as drawing them in order.
+ * @param width Output width of the raster, its height is half that.
+ * @return Pointer to the raster, or 0 if the globe is zoomed in too close.
+ */
+const std::vector<Uint8> *Globe::getLandRaster(int *width)
+{
+	if (_landRasterWidth.size() != _zoomRadius.size())
+	{
+		_landRaster.assign(_zoomRadius.size(), std::vector<Uint8>());
+		_landRasterWidth.assign(_zoomRadius.size(), 0);
+	}
+	// stretching the cells a bit is fine, beyond that draw the polygons
+	if (_landRasterWidth[_zoom] < 0 || 2 * M_PI * _radius > LAND_RASTER_MAX_WIDTH * 1.25)
+	{
+		return 0;
+	}
+	*width = _landRasterWidth[_zoom];
+	if (*width != 0)
+	{
+		return &_landRaster[_zoom];
+	}
+
+	int w = std::min((int)ceil(2 * M_PI * _zoomRadius[_zoom]), LAND_RASTER_MAX_WIDTH);
+	w += w % 2;
+	const int h = w / 2;
+	const double cell = 2 * M_PI / w;
+	std::vector<Uint8> &raster = _landRaster[_zoom];
+	raster.assign(w * h, 0);
+
+	std::vector<double> lonSin(w), lonCos(w), latSin(h), latCos(h);
+	for (int x = 0; x < w; ++x)
+	{
+		lonSin[x] = sin((x + 0.5) * cell);
+		lonCos[x] = cos((x + 0.5) * cell);
+	}
+	for (int y = 0; y < h; ++y)
+	{
+		latSin[y] = sin((y + 0.5) * cell - M_PI_2);
+		latCos[y] = cos((y + 0.5) * cell - M_PI_2);
+	}
+
+	std::vector<Cord> points;
+	for (std::list<Polygon*>::iterator i = _rules->getPolygons()->begin(); i != _rules->getPolygons()->end(); ++i)
+	{
+		const int n = (*i)->getPoints();
+		if (n < 3)
+		{
+			continue;
+		}
+		if ((*i)->getTexture() < 0 || (*i)->getTexture() > 254)
+		{
+			// doesn't fit in the raster
+			_landRaster[_zoom].clear();
+			_landRasterWidth[_zoom] = -1;
+			return 0;
+		}
+		points.resize(n);
+		for (int j = 0; j < n; ++j)
+		{
+			double lat = (*i)->getLatitude(j), lon = (*i)->getLongitude(j);
+			points[j] = Cord(cos(lat) * cos(lon), cos(lat) * sin(lon), sin(lat));
+		}
+
+		// a degree of margin, as the edges bend away from great circles
+		double minLon, maxLon, minLat, maxLat;
+		bool fullLon = !getPolygonBounds(*i, minLon, maxLon, minLat, maxLat);
+		const int margin = (int)ceil(w / 360.0);
+		int y1 = Clamp((int)floor((minLat + M_PI_2) / cell) - margin, 0, h - 1);
+		int y2 = Clamp((int)floor((maxLat + M_PI_2) / cell) + margin, 0, h - 1);
+		int x1 = 0, x2 = w - 1;
+		if (!fullLon)
+		{
+			double nearPole = std::min(std::max(std::abs(minLat), std::abs(maxLat)) + M_PI / 180, M_PI_2);
+			int marginLon = (int)std::min(margin / std::max(cos(nearPole), 1e-3), (double)w);
+			x1 = (int)floor(minLon / cell) - marginLon;
+			x2 = (int)floor(maxLon / cell) + marginLon;
+			if (x2 - x1 >= w)
+			{
+				x1 = 0;
+				x2 = w - 1;
+			}
+		}
+
+		const Uint8 texture = (*i)->getTexture() + 1;
+		for (int y = y1; y <= y2; ++y)
+		{
+			const double sinlat = latSin[y], coslat = latCos[y];
+			for (int x = x1; x <= x2; ++x)
+			{
+				const int cx = (x % w + w) % w;
+				const double sinlon = lonSin[cx], coslon = lonCos[cx];
+				// same test as getPolygonFromLonLat(), projecting the points around the cell
+				bool odd = false, front = true;
+				const Cord &last = points[n - 1];
+				double px = last.y * coslon - last.x * sinlon;
+				double py = last.z * coslat - sinlat * (last.x * coslon + last.y * sinlon);
+				for (int j = 0; j < n && front; ++j)
+				{
+					const Cord &p = points[j];
+					front = coslat * (p.x * coslon + p.y * sinlon) + sinlat * p.z > 0;
+					double qx = p.y * coslon - p.x * sinlon;
+					double qy = p.z * coslat - sinlat * (p.x * coslon + p.y * sinlon);
+					if (((py > 0) != (qy > 0)) && (0 < (qx - px) * (0 - py) / (qy - py) + px))
+						odd = !odd;
+					px = qx;
+					py = qy;
+				}
+				if (odd && front)
+				{
+					raster[y * w + cx] = texture;
+				}
+			}
+		}
+	}
+	_landRasterWidth[_zoom] = w;
+	*width = w;
+	return &raster;
+}
+
+/**
+ * Projects each pixel of the globe back to lon/lat and keeps the land
+ * raster cell it falls in. The row and the longitude relative to the centre
+ * don't depend on the centre longitude, so they only have to be projected
+ * again when the view is tilted, zoomed or moved on the screen, not when
+ * the globe is spun around.
+ * @param width Width of the land raster.
+ */
+void Globe::projectLandCells(int width)
+{
+	const int height = width / 2;
+	const double cellsPerRadian = width / (2 * M_PI);
+	const double invRadius = 1.0 / _radius;
+	const double cosCenLat = cos(_cenLat), sinCenLat = sin(_cenLat);
+
+	_landCellRow.assign(getWidth() * getHeight(), -1);
+	_landCellLon.assign(getWidth() * getHeight(), 0.0f);
+
+	const int y1 = std::max(0, (int)floor(_cenY - _radius)), y2 = std::min(getHeight(), (int)ceil(_cenY + _radius) + 1);
+	const int x1 = std::max(0, (int)floor(_cenX - _radius)), x2 = std::min(getWidth(), (int)ceil(_cenX + _radius) + 1);
+	for (int y = y1; y < y2; ++y)
+	{
+		const double ny = (y + 0.5 - _cenY) * invRadius;
+		for (int x = x1; x < x2; ++x)
+		{
+			const double nx = (x + 0.5 - _cenX) * invRadius;
+			const double d = 1.0 - nx * nx - ny * ny;
+			if (d <= 0.0)
+			{
+				continue;
+			}
+			const double nz = sqrt(d);
+			double lat = asin(Clamp(ny * cosCenLat + nz * sinCenLat, -1.0, 1.0));
+			double lon = atan2(nx, nz * cosCenLat - ny * sinCenLat);
+			_landCellRow[y * getWidth() + x] = std::min((int)((lat + M_PI_2) * cellsPerRadian), height - 1);
+			_landCellLon[y * getWidth() + x] = (float)(lon * cellsPerRadian);
+		}
+	}
+	_landCellCenLat = _cenLat;
+	_landCellRadius = _radius;
+	_landCellCenX = _cenX;
+	_landCellCenY = _cenY;
+	_landCellWidth = width;
+}
+
+/**
+ * Draws the land by looking up the texture of each pixel of the globe
+ * in a land raster, using the cells from projectLandCells(). The textures
+ * are tiled in screen space, like drawTexturedPolygon() does.
+ * @param raster Land raster to sample.
+ * @param width Width of the raster.
+ */
+void Globe::drawLandRaster(const std::vector<Uint8> &raster, int width)
+{
+	if (_landCellRow.size() != (size_t)(getWidth() * getHeight()) || _landCellWidth != width || _landCellCenLat != _cenLat ||
+		_landCellRadius != _radius || _landCellCenX != _cenX || _landCellCenY != _cenY)
+	{
+		projectLandCells(width);
+	}
+	const double cenCells = _cenLon * width / (2 * M_PI);
+	Surface *frames[256] = {};
+
+	const int y1 = std::max(0, (int)floor(_cenY - _radius)), y2 = std::min(getHeight(), (int)ceil(_cenY + _radius) + 1);
+	const int x1 = std::max(0, (int)floor(_cenX - _radius)), x2 = std::min(getWidth(), (int)ceil(_cenX + _radius) + 1);
+
+	lock();
+	for (int y = y1; y < y2; ++y)
+	{
+		const Sint16 *row = &_landCellRow[y * getWidth()];
+		const float *lon = &_landCellLon[y * getWidth()];
+		for (int x = x1; x < x2; ++x)
+		{
+			const int cy = row[x];
+			if (cy < 0)
+			{
+				continue;
+			}
+			int cx = (int)floor(lon[x] + cenCells) % width;
+			if (cx < 0) cx += width;
+
+			const Uint8 texture = raster[cy * width + cx];
+			if (texture == 0)
+			{
+				continue;
+			}
+			Surface *frame = frames[texture];
+			if (frame == 0)
+			{
+				frame = frames[texture] = _texture->getFrame(texture - 1 + _zoomTexture);
+			}
+			const Uint8 color = frame->getPixel(x % frame->getWidth(), y % frame->getHeight());
+			if (color != 0)
+			{
+				setPixel(x, y, color);
+			}
+		}
+	}
+	unlock();
+}
+
 /**
  * Get position of sun from point on globe
  * @param lon longitude of position
@@ -976,17 +1334,51 @@ Cord Globe::getSunDirection(double lon, double lat) const
 }
 
 
+/**
+ * Darkens the night side of the globe. The shade of each pixel only
+ * depends on the view and the sun, so it's kept from the last time
+ * unless the view changed or the sun moved far enough to change a shade
+ * step, and then laid over the ocean and land colors row by row.
+ */
 void Globe::drawShadow()
 {
-	ShaderMove<Cord> earth = ShaderMove<Cord>(_earthData[_zoom], getWidth(), getHeight());
-	ShaderRepeat<Sint16> noise = ShaderRepeat<Sint16>(_randomNoiseData, static_data.random_surf_size, static_data.random_surf_size);
+	const int width = getWidth(), height = getHeight();
+	const int moveX = _cenX - width / 2, moveY = _cenY - height / 2;
+	const Cord sun = getSunDirection(_cenLon, _cenLat);
+
+	// a shade step is 1/250 of the dot product between the sun and a pixel normal
+	Cord moved = sun;
+	moved -= _shadowSun;
+	if (_shadowOcean.size() != (size_t)(width * height) || _shadowZoom != _zoom || _shadowCenX != _cenX || _shadowCenY != _cenY || moved.norm() >= 1.0 / 250)
+	{
+		ShaderMove<Cord> earth = ShaderMove<Cord>(_earthData[_zoom], width, height);
+		ShaderRepeat<Sint16> noise = ShaderRepeat<Sint16>(_randomNoiseData, static_data.random_surf_size, static_data.random_surf_size);
+		earth.setMove(moveX, moveY);
 
-	earth.setMove(_cenX-getWidth()/2, _cenY-getHeight()/2);
+		_shadowOcean.assign(width * height, 0);
+		_shadowLand.assign(width * height, helper::ShadeRow::ShadowOutside);
+		ShaderDraw<CreateShadow>(ShaderMove<Uint8>(_shadowOcean, width, height), ShaderMove<Uint8>(_shadowLand, width, height), earth, ShaderScalar(sun), noise);
+		_shadowSun = sun;
+		_shadowZoom = _zoom;
+		_shadowCenX = _cenX;
+		_shadowCenY = _cenY;
+	}
 
+	// only the part the normals cover gets shaded
+	const int x1 = std::max(0, moveX), x2 = std::min(width, moveX + width);
+	const int y1 = std::max(0, moveY), y2 = std::min(height, moveY + height);
+	if (x1 >= x2)
+	{
+		return;
+	}
+	const helper::ShadeRow &row = helper::ShadeRow::get();
 	lock();
-	ShaderDraw<CreateShadow>(ShaderSurface(this), earth, ShaderScalar(getSunDirection(_cenLon, _cenLat)), noise);
+	for (int y = y1; y < y2; ++y)
+	{
+		Uint8 *dest = (Uint8 *)getSurface()->pixels + y * getSurface()->pitch + x1;
+		row.shadow(dest, &_shadowOcean[y * width + x1], &_shadowLand[y * width + x1], x2 - x1, OCEAN_COLOR);
+	}
 	unlock();
-
 }
 
 
@@ -1257,63 +1649,52 @@ void Globe::drawDetail()
 		_countries->unlock();
 	}
 
-	// Draw the country names
 	if (_zoom >= 2)
 	{
-		Text *label = new Text(100, 9, 0, 0);
-		label->setPalette(getPalette());
-		label->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
-		label->setAlign(ALIGN_CENTER);
-		label->setColor(COUNTRY_LABEL_COLOR);
-
-		Sint16 x, y;
-		for (std::vector<Country*>::iterator i = _game->getSavedGame()->getCountries()->begin(); i != _game->getSavedGame()->getCountries()->end(); ++i)
+		cacheLabels();
+		if (_labelCenLon != _cenLon || _labelCenLat != _cenLat || _labelRadius != _radius || _labelCenX != _cenX || _labelCenY != _cenY)
 		{
-			// Don't draw if label is facing back
-			if (pointBack((*i)->getRules()->getLabelLongitude(), (*i)->getRules()->getLabelLatitude()))
-				continue;
-
-			// Convert coordinates
-			polarToCart((*i)->getRules()->getLabelLongitude(), (*i)->getRules()->getLabelLatitude(), &x, &y);
-
-			label->setX(x - 50);
-			label->setY(y);
-			label->setText(_game->getLanguage()->getString((*i)->getRules()->getType()));
-			label->blit(_countries);
+			projectLabels(_countryLabels, 0);
+			projectLabels(_cityLabels, 2);
+			_labelCenLon = _cenLon;
+			_labelCenLat = _cenLat;
+			_labelRadius = _radius;
+			_labelCenX = _cenX;
+			_labelCenY = _cenY;
 		}
+	}
 
-		delete label;
+	// Draw the country names
+	if (_zoom >= 2)
+	{
+		for (std::vector<GlobeLabel>::iterator i = _countryLabels.begin(); i != _countryLabels.end(); ++i)
+		{
+			if (i->visible)
+			{
+				i->text->blit(_countries);
+			}
+		}
 	}
 
 	// Draw the city and base markers
 	if (_zoom >= 3)
 	{
+		for (std::vector<GlobeLabel>::iterator i = _cityLabels.begin(); i != _cityLabels.end(); ++i)
+		{
+			// Only the cities facing front and on the screen
+			if (i->visible)
+			{
+				drawTarget(i->target, _countries);
+				i->text->blit(_countries);
+			}
+		}
+
 		Text *label = new Text(100, 9, 0, 0);
 		label->setPalette(getPalette());
 		label->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
 		label->setAlign(ALIGN_CENTER);
-		label->setColor(CITY_LABEL_COLOR);
 
 		Sint16 x, y;
-		for (std::vector<Region*>::iterator i = _game->getSavedGame()->getRegions()->begin(); i != _game->getSavedGame()->getRegions()->end(); ++i)
-		{
-			for (std::vector<City*>::iterator j = (*i)->getRules()->getCities()->begin(); j != (*i)->getRules()->getCities()->end(); ++j)
-			{
-				drawTarget(*j, _countries);
-
-				// Don't draw if city is facing back
-				if (pointBack((*j)->getLongitude(), (*j)->getLatitude()))
-					continue;
-
-				// Convert coordinates
-				polarToCart((*j)->getLongitude(), (*j)->getLatitude(), &x, &y);
-
-				label->setX(x - 50);
-				label->setY(y + 2);
-				label->setText((*j)->getName(_game->getLanguage()));
-				label->blit(_countries);
-			}
-		}
 		// Draw bases names
 		for (std::vector<Base*>::iterator j = _game->getSavedGame()->getBases()->begin(); j != _game->getSavedGame()->getBases()->end(); ++j)
 		{
@@ -1484,6 +1865,107 @@ void Globe::drawFlights()
 	_radars->unlock();
 }
 
+/**
+ * Creates a text label for a point on the globe,
+ * rendered once so redraws only have to blit it.
+ * @param lon Longitude of the point.
+ * @param lat Latitude of the point.
+ * @param target Target drawn with the label, if any.
+ * @param name Text of the label.
+ * @param color Color of the label.
+ * @return New label, not projected yet.
+ */
+Globe::GlobeLabel Globe::createLabel(double lon, double lat, Target *target, const std::wstring &name, Uint8 color)
+{
+	GlobeLabel label;
+	label.lon = lon;
+	label.lat = lat;
+	label.target = target;
+	label.text = new Text(100, 9, 0, 0);
+	label.text->setPalette(getPalette());
+	label.text->initText(_game->getMod()->getFont("FONT_BIG"), _game->getMod()->getFont("FONT_SMALL"), _game->getLanguage());
+	label.text->setAlign(ALIGN_CENTER);
+	label.text->setColor(color);
+	label.text->setText(name);
+	label.x = 0;
+	label.y = 0;
+	label.visible = false;
+	return label;
+}
+
+/**
+ * Deletes all the pre-rendered labels,
+ * so they get made again on the next redraw.
+ */
+void Globe::clearLabels()
+{
+	for (std::vector<GlobeLabel>::iterator i = _countryLabels.begin(); i != _countryLabels.end(); ++i)
+	{
+		delete i->text;
+	}
+	for (std::vector<GlobeLabel>::iterator i = _cityLabels.begin(); i != _cityLabels.end(); ++i)
+	{
+		delete i->text;
+	}
+	_countryLabels.clear();
+	_cityLabels.clear();
+	_labelLanguage.clear();
+	_labelRadius = 0.0;
+}
+
+/**
+ * Makes a label for every country and city name, unless they're
+ * already there for the current language.
+ */
+void Globe::cacheLabels()
+{
+	size_t cities = 0;
+	for (std::vector<Region*>::iterator i = _game->getSavedGame()->getRegions()->begin(); i != _game->getSavedGame()->getRegions()->end(); ++i)
+	{
+		cities += (*i)->getRules()->getCities()->size();
+	}
+	if (_labelLanguage == _game->getLanguage()->getId() && _countryLabels.size() == _game->getSavedGame()->getCountries()->size() && _cityLabels.size() == cities)
+		return;
+
+	clearLabels();
+	_labelLanguage = _game->getLanguage()->getId();
+	for (std::vector<Country*>::iterator i = _game->getSavedGame()->getCountries()->begin(); i != _game->getSavedGame()->getCountries()->end(); ++i)
+	{
+		_countryLabels.push_back(createLabel((*i)->getRules()->getLabelLongitude(), (*i)->getRules()->getLabelLatitude(), 0, _game->getLanguage()->getString((*i)->getRules()->getType()), COUNTRY_LABEL_COLOR));
+	}
+	_cityLabels.reserve(cities);
+	for (std::vector<Region*>::iterator i = _game->getSavedGame()->getRegions()->begin(); i != _game->getSavedGame()->getRegions()->end(); ++i)
+	{
+		for (std::vector<City*>::iterator j = (*i)->getRules()->getCities()->begin(); j != (*i)->getRules()->getCities()->end(); ++j)
+		{
+			_cityLabels.push_back(createLabel((*j)->getLongitude(), (*j)->getLatitude(), *j, (*j)->getName(_game->getLanguage()), CITY_LABEL_COLOR));
+		}
+	}
+}
+
+/**
+ * Works out where the labels go on the globe for the current view,
+ * leaving out the ones facing back or off the screen.
+ * @param labels List of labels.
+ * @param offY Vertical offset of the text from the point.
+ */
+void Globe::projectLabels(std::vector<GlobeLabel> &labels, int offY)
+{
+	for (std::vector<GlobeLabel>::iterator i = labels.begin(); i != labels.end(); ++i)
+	{
+		// Don't draw if label is facing back
+		i->visible = !pointBack(i->lon, i->lat);
+		if (!i->visible)
+			continue;
+
+		// Convert coordinates
+		polarToCart(i->lon, i->lat, &i->x, &i->y);
+		i->visible = i->x + 50 >= 0 && i->x - 50 < getWidth() && i->y + offY + 9 >= 0 && i->y - 1 < getHeight();
+		i->text->setX(i->x - 50);
+		i->text->setY(i->y + offY);
+	}
+}
+
 /**
  * Draws the marker for a specified target on the globe.
  * @param target Pointer to globe target.
@@ -1828,7 +2310,7 @@ void Globe::getPolygonTextureAndShade(double lon, double lat, int *texture, int
 							 7, 7, 8, 8, 9, 9,10,11,
 							11,12,12,13,13,14,15,15};
 
-	*shade = worldshades[ CreateShadow::getShadowValue(0, Cord(0.,0.,1.), getSunDirection(lon, lat), 0) ];
+	*shade = worldshades[ CreateShadow::getShadowValue(Cord(0.,0.,1.), getSunDirection(lon, lat), 0) ];
 	Polygon *t = getPolygonFromLonLat(lon,lat);
 	*texture = (t==NULL)? -1 : t->getTexture();
 }
@@ -1892,6 +2374,8 @@ void Globe::setupRadii(int width, int height)
 
 	_radius = _zoomRadius[_zoom];
 	_radiusStep = (_zoomRadius[DOGFIGHT_ZOOM] - _zoomRadius[0]) / 10.0;
+	_landRaster.clear();
+	_landRasterWidth.clear();
 
 	_earthData.resize(_zoomRadius.size());
 	//filling normal field for each radius
@@ -31,6 +31,7 @@ class Polygon;
 class SurfaceSet;
 class Timer;
 class Target;
+class Text;
 class LocalizedText;
 class RuleGlobe;
 
@@ -48,9 +49,22 @@ private:
 	static const int NEAR_RADIUS = 25;
 	static const size_t DOGFIGHT_ZOOM = 3;
 	static const int CITY_MARKER = 8;
+	static const int POLYGON_INDEX_LON = 180;
+	static const int POLYGON_INDEX_LAT = 90;
+	static const int LAND_RASTER_MAX_WIDTH = 4096;
 	static const double ROTATE_LONGITUDE;
 	static const double ROTATE_LATITUDE;
 
+	/// Name drawn over a point of the detailed globe.
+	struct GlobeLabel
+	{
+		double lon, lat;
+		Target *target;
+		Text *text;
+		Sint16 x, y;
+		bool visible;
+	};
+
 	RuleGlobe *_rules;
 	double _cenLon, _cenLat, _rotLon, _rotLat, _hoverLon, _hoverLat;
 	Sint16 _cenX, _cenY;
@@ -62,6 +76,20 @@ private:
 	int _blink;
 	Timer *_blinkTimer, *_rotTimer;
 	std::list<Polygon*> _cacheLand;
+	///true if the globe moved since the polygons were last cached
+	bool _cacheLandDirty;
+	///land polygons that can overlap each lon/lat cell, in ruleset order
+	std::vector<std::vector<Polygon*> > _polygonIndex;
+	///texture of the land over each lon/lat cell per zoom level, 0 for water, texture + 1 for land
+	std::vector<std::vector<Uint8> > _landRaster;
+	///width of the land raster per zoom level, 0 if not made yet, -1 if it can't be made
+	std::vector<int> _landRasterWidth;
+	///land raster row of each globe pixel (-1 off the globe) and its column relative to the centre longitude, and the view they were projected for
+	std::vector<Sint16> _landCellRow;
+	std::vector<float> _landCellLon;
+	double _landCellCenLat, _landCellRadius;
+	Sint16 _landCellCenX, _landCellCenY;
+	int _landCellWidth;
 	FastLineClip *_clipper;
 	double _radius, _radiusStep;
 	///normal of each pixel in earth globe per zoom level
@@ -70,6 +98,16 @@ private:
 	std::vector<Sint16> _randomNoiseData;
 	///list of dimension of earth on screen per zoom level
 	std::vector<double> _zoomRadius;
+	///shade of each globe pixel over ocean and over land, and the view and sun they were made for
+	std::vector<Uint8> _shadowOcean, _shadowLand;
+	Cord _shadowSun;
+	size_t _shadowZoom;
+	Sint16 _shadowCenX, _shadowCenY;
+	///pre-rendered country and city names, the language they were made in and the view they were projected for
+	std::vector<GlobeLabel> _countryLabels, _cityLabels;
+	std::string _labelLanguage;
+	double _labelCenLon, _labelCenLat, _labelRadius;
+	Sint16 _labelCenX, _labelCenY;
 
 	bool _isMouseScrolling, _isMouseScrolled;
 	int _xBeforeMouseScrolling, _yBeforeMouseScrolling;
@@ -84,8 +122,18 @@ private:
 	bool pointBack(double lon, double lat) const;
 	/// Return latitude of last visible to player point on given longitude.
 	double lastVisibleLat(double lon) const;
+	/// Fills the polygon index.
+	void buildPolygonIndex();
+	/// Gets the polygon index cell of a point.
+	int getPolygonIndexCell(double lon, double lat) const;
 	/// Get polygon pointer
 	Polygon* getPolygonFromLonLat(double lon, double lat) const;
+	/// Gets the land raster of the current zoom level.
+	const std::vector<Uint8> *getLandRaster(int *width);
+	/// Projects the globe pixels back to land raster cells.
+	void projectLandCells(int width);
+	/// Draws the land from a land raster.
+	void drawLandRaster(const std::vector<Uint8> &raster, int width);
 	/// Checks if a target is near a point.
 	bool targetNear(Target* target, int x, int y) const;
 	/// Caches a set of polygons.
@@ -102,6 +150,14 @@ private:
 	void drawPath(Surface *surface, double lon1, double lat1, double lon2, double lat2);
 	/// Draw target marker.
 	void drawTarget(Target *target, Surface *surface);
+	/// Creates a pre-rendered label.
+	GlobeLabel createLabel(double lon, double lat, Target *target, const std::wstring &name, Uint8 color);
+	/// Deletes the pre-rendered labels.
+	void clearLabels();
+	/// Pre-renders the country and city names.
+	void cacheLabels();
+	/// Projects the labels on the globe.
+	void projectLabels(std::vector<GlobeLabel> &labels, int offY);
 public:
 
 	static Uint8 COUNTRY_LABEL_COLOR;
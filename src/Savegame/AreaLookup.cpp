@@ -0,0 +1,172 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AreaLookup.h"
+#include <algorithm>
+#include <cmath>
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an empty lookup, with nothing to find.
+ */
+AreaLookup::AreaLookup() : _areas(0), _resolution(0), _cellsLon(0), _cellsLat(0), _cellSize(0.0)
+{
+}
+
+/**
+ *
+ */
+AreaLookup::~AreaLookup()
+{
+}
+
+/**
+ * Removes all areas and empties the raster.
+ */
+void AreaLookup::clear()
+{
+	_rects.clear();
+	_cells.clear();
+	_areas = 0;
+}
+
+/**
+ * Adds the next area, with the same rectangles RuleRegion::insideRegion()
+ * and RuleCountry::insideCountry() test. Rectangles with a minimum longitude
+ * over the maximum wrap around the 0 meridian.
+ * @param lonMin Minimum longitudes, in radians.
+ * @param lonMax Maximum longitudes, in radians.
+ * @param latMin Minimum latitudes, in radians.
+ * @param latMax Maximum latitudes, in radians.
+ */
+void AreaLookup::addArea(const std::vector<double> &lonMin, const std::vector<double> &lonMax, const std::vector<double> &latMin, const std::vector<double> &latMax)
+{
+	for (size_t i = 0; i < lonMin.size(); ++i)
+	{
+		Rect rect;
+		rect.area = _areas;
+		rect.latMin = latMin[i];
+		rect.latMax = latMax[i];
+		if (lonMin[i] <= lonMax[i])
+		{
+			rect.lonMin = lonMin[i];
+			rect.lonMax = lonMax[i];
+			_rects.push_back(rect);
+		}
+		else
+		{
+			rect.lonMin = lonMin[i];
+			rect.lonMax = M_PI * 2.0;
+			_rects.push_back(rect);
+			rect.lonMin = 0.0;
+			rect.lonMax = lonMax[i];
+			_rects.push_back(rect);
+		}
+	}
+	_areas++;
+}
+
+/**
+ * Fills the raster from the areas added so far. A cell gets an area if
+ * that is the only one touching it and one of its rectangles covers it
+ * whole, NONE if no area touches it, and BORDER otherwise. Cells are
+ * compared with a small margin, so points right on a rectangle edge
+ * always end up in a BORDER cell and get tested exactly.
+ * @param cellsPerDegree Resolution of the raster.
+ */
+void AreaLookup::build(int cellsPerDegree)
+{
+	const double margin = 1e-9;
+	_resolution = cellsPerDegree;
+	cellsPerDegree = Clamp(cellsPerDegree, 1, 16);
+	_cellsLon = 360 * cellsPerDegree;
+	_cellsLat = 180 * cellsPerDegree;
+	_cellSize = M_PI / _cellsLat;
+	_cells.assign(_cellsLon * _cellsLat, (int)NONE);
+	std::vector<bool> covered(_cells.size(), false);
+
+	for (std::vector<Rect>::const_iterator r = _rects.begin(); r != _rects.end(); ++r)
+	{
+		int x1 = Clamp((int)floor((r->lonMin - margin) / _cellSize), 0, _cellsLon - 1);
+		int x2 = Clamp((int)floor((r->lonMax + margin) / _cellSize), 0, _cellsLon - 1);
+		int y1 = Clamp((int)floor((r->latMin + M_PI_2 - margin) / _cellSize), 0, _cellsLat - 1);
+		int y2 = Clamp((int)floor((r->latMax + M_PI_2 + margin) / _cellSize), 0, _cellsLat - 1);
+		for (int y = y1; y <= y2; ++y)
+		{
+			double cellLatMin = y * _cellSize - M_PI_2;
+			double cellLatMax = cellLatMin + _cellSize;
+			if (r->latMin >= cellLatMax + margin || r->latMax <= cellLatMin - margin)
+			{
+				continue;
+			}
+			for (int x = x1; x <= x2; ++x)
+			{
+				double cellLonMin = x * _cellSize;
+				double cellLonMax = cellLonMin + _cellSize;
+				if (r->lonMin >= cellLonMax + margin || r->lonMax <= cellLonMin - margin)
+				{
+					continue;
+				}
+				int i = y * _cellsLon + x;
+				if (_cells[i] == NONE)
+				{
+					_cells[i] = r->area;
+				}
+				else if (_cells[i] != r->area)
+				{
+					_cells[i] = BORDER;
+				}
+				if (r->lonMin <= cellLonMin - margin && r->lonMax >= cellLonMax + margin &&
+					r->latMin <= cellLatMin - margin && r->latMax >= cellLatMax + margin)
+				{
+					covered[i] = true;
+				}
+			}
+		}
+	}
+	for (size_t i = 0; i < _cells.size(); ++i)
+	{
+		if (_cells[i] >= 0 && !covered[i])
+		{
+			_cells[i] = BORDER;
+		}
+	}
+}
+
+/**
+ * Finds which area covers a point, as far as the raster knows.
+ * @param lon Longitude in radians.
+ * @param lat Latitude in radians.
+ * @return Index of the area in the order they were added, NONE if no area
+ * covers the point, or BORDER if the areas need to be tested exactly.
+ */
+int AreaLookup::find(double lon, double lat) const
+{
+	if (_cells.empty() || lon < 0.0 || lon >= M_PI * 2.0 || lat < -M_PI_2 || lat >= M_PI_2)
+	{
+		return BORDER;
+	}
+	int x = std::min((int)(lon / _cellSize), _cellsLon - 1);
+	int y = std::min((int)((lat + M_PI_2) / _cellSize), _cellsLat - 1);
+	return _cells[y * _cellsLon + x];
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+namespace OpenXcom
+{
+
+/**
+ * Lookup raster for finding which of a list of areas (like regions or
+ * countries), each made of lon/lat rectangles, covers a point on the globe.
+ * Every cell of an equirectangular grid remembers the one area covering it
+ * whole; cells on a border fall back to testing the areas exactly.
+ */
+class AreaLookup
+{
+public:
+	static const int NONE = -1;
+	static const int BORDER = -2;
+private:
+	struct Rect
+	{
+		int area;
+		double lonMin, lonMax, latMin, latMax;
+	};
+	std::vector<Rect> _rects;
+	std::vector<int> _cells;
+	int _areas, _resolution, _cellsLon, _cellsLat;
+	double _cellSize;
+public:
+	/// Creates an empty lookup.
+	AreaLookup();
+	/// Cleans up the lookup.
+	~AreaLookup();
+	/// Removes all areas.
+	void clear();
+	/// Adds an area made of lon/lat rectangles.
+	void addArea(const std::vector<double> &lonMin, const std::vector<double> &lonMax, const std::vector<double> &latMin, const std::vector<double> &latMax);
+	/// Gets the number of areas added.
+	int getAreas() const { return _areas; }
+	/// Fills the raster.
+	void build(int cellsPerDegree);
+	/// Checks if the raster is filled.
+	bool isBuilt() const { return !_cells.empty(); }
+	/// Gets the resolution the raster was filled with.
+	int getResolution() const { return _resolution; }
+	/// Finds the area covering a point.
+	int find(double lon, double lat) const;
+};
+
+}
@@ -449,6 +449,24 @@ int Base::insideRadarRange(Target *target) const
 	return insideRange? 1 : 0;
 }
 
+/**
+ * Returns the range of the longest finished radar
+ * in the base, past which it can't detect anything.
+ * @return Radar range in nautical miles.
+ */
+int Base::getMaxRadarRange() const
+{
+	int range = 0;
+	for (std::vector<BaseFacility*>::const_iterator i = _facilities.begin(); i != _facilities.end(); ++i)
+	{
+		if ((*i)->getBuildTime() == 0)
+		{
+			range = std::max(range, (*i)->getRules()->getRadarRange());
+		}
+	}
+	return range;
+}
+
 /**
  * Returns the amount of soldiers contained
  * in the base without any assignments.
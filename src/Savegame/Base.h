@@ -106,6 +106,8 @@ public:
 	int detect(Target *target) const;
 	/// Checks if a target is inside the base's radar range.
 	int insideRadarRange(Target *target) const;
+	/// Gets the range of the base's longest radar.
+	int getMaxRadarRange() const;
 	/// Gets the base's available soldiers.
 	int getAvailableSoldiers(bool checkCombatReadiness = false) const;
 	/// Gets the base's total soldiers.
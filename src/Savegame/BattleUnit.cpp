@@ -19,6 +19,7 @@
 #include "BattleUnit.h"
 #include "BattleItem.h"
 #include <sstream>
+#include <algorithm>
 #include "../Engine/Surface.h"
 #include "../Engine/Script.h"
 #include "../Engine/ScriptBind.h"
@@ -1603,13 +1604,21 @@ void BattleUnit::clearVisibleUnits()
 /**
  * Add this unit to the list of visible tiles.
  * @param tile that we're now able to see.
+ * @param tileIndex Index of the tile in the battle map.
  * @return true if a new tile.
  */
-bool BattleUnit::addToVisibleTiles(Tile *tile)
+bool BattleUnit::addToVisibleTiles(Tile *tile, int tileIndex)
 {
+	size_t word = tileIndex / 64;
+	Uint64 bit = 1ULL << (tileIndex % 64);
+	if (word >= _visibleTilesLookup.size())
+	{
+		_visibleTilesLookup.resize(word + 1, 0);
+	}
 	//Only add once, otherwise we're going to mess up the visibility value and make trouble for the AI (if sneaky).
-	if (_visibleTilesLookup.insert(tile).second)
+	if (!(_visibleTilesLookup[word] & bit))
 	{
+		_visibleTilesLookup[word] |= bit;
 		tile->setVisible(1);
 		_visibleTiles.push_back(tile);
 		return true;
@@ -1617,9 +1626,15 @@ bool BattleUnit::addToVisibleTiles(Tile *tile)
 	return false;
 }
 
-bool BattleUnit::hasVisibleTile(Tile *tile) const
+/**
+ * Has this unit marked this tile as within its view?
+ * @param tileIndex Index of the tile in the battle map.
+ * @return True if the tile was added to the visible tiles.
+ */
+bool BattleUnit::hasVisibleTile(int tileIndex) const
 {
-	return _visibleTilesLookup.find(tile) != _visibleTilesLookup.end(); //find?
+	size_t word = tileIndex / 64;
+	return word < _visibleTilesLookup.size() && (_visibleTilesLookup[word] & (1ULL << (tileIndex % 64)));
 }
 
 /**
@@ -1636,11 +1651,16 @@ const std::vector<Tile*> *BattleUnit::getVisibleTiles()
  */
 void BattleUnit::clearVisibleTiles()
 {
+	if (_visibleTiles.empty())
+	{
+		return;
+	}
 	for (std::vector<Tile*>::iterator j = _visibleTiles.begin(); j != _visibleTiles.end(); ++j)
 	{
 		(*j)->setVisible(-1);
 	}
-	_visibleTilesLookup.clear();
+	// keeps the bitset allocated, clearing it is a plain memset
+	std::fill(_visibleTilesLookup.begin(), _visibleTilesLookup.end(), 0);
 	_visibleTiles.clear();
 }
 
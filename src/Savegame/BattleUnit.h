@@ -19,7 +19,6 @@
  */
 #include <vector>
 #include <string>
-#include <unordered_set>
 #include "../Battlescape/Position.h"
 #include "../Battlescape/BattlescapeGame.h"
 #include "../Mod/RuleItem.h"
@@ -90,7 +89,7 @@ private:
 	int _walkPhase, _fallPhase;
 	std::vector<BattleUnit *> _visibleUnits, _unitsSpottedThisTurn;
 	std::vector<Tile *> _visibleTiles;
-	std::unordered_set<Tile *> _visibleTilesLookup;
+	std::vector<Uint64> _visibleTilesLookup;
 	int _tu, _energy, _health, _morale, _stunlevel;
 	bool _kneeled, _floating, _dontReselect;
 	int _currentArmor[SIDE_MAX], _maxArmor[SIDE_MAX];
@@ -289,9 +288,9 @@ public:
 	/// Clear visible units.
 	void clearVisibleUnits();
 	/// Add unit to visible tiles.
-	bool addToVisibleTiles(Tile *tile);
+	bool addToVisibleTiles(Tile *tile, int tileIndex);
 	/// Has this unit marked this tile as within its view?
-	bool hasVisibleTile(Tile *tile) const;
+	bool hasVisibleTile(int tileIndex) const;
 	/// Get the list of visible tiles.
 	const std::vector<Tile*> *getVisibleTiles();
 	/// Clear visible tiles.
@@ -967,6 +967,16 @@ bool Craft::isDestroyed() const
 	return (_damage >= _stats.damageMax);
 }
 
+/**
+ * Gets if the craft is still taking off from its base,
+ * which takes a while before it starts moving.
+ * @return Is the craft taking off?
+ */
+bool Craft::isTakingOff() const
+{
+	return _takeoff != 0;
+}
+
 /**
  * Returns the amount of space available for
  * soldiers and vehicles.
@@ -169,6 +169,8 @@ public:
 	bool isInBattlescape() const;
 	/// Gets if craft is destroyed during dogfights.
 	bool isDestroyed() const;
+	/// Gets if craft is still taking off from its base.
+	bool isTakingOff() const;
 	/// Gets the amount of space available inside a craft.
 	int getSpaceAvailable() const;
 	/// Gets the amount of space used inside a craft.
@@ -136,6 +136,31 @@ TimeTrigger GameTime::advance()
 	return trigger;
 }
 
+/**
+ * Gets how many times advance() can be called until it returns
+ * a trigger other than TIME_5SEC, counting that call too.
+ * @return Number of 5 second steps.
+ */
+int GameTime::getStepsToNextTrigger() const
+{
+	// steps to finish this minute, then a full minute for each one left until the next 10 minutes
+	int minutesLeft = 10 - _minute % 10;
+	return (60 - _second) / 5 + 12 * (minutesLeft - 1);
+}
+
+/**
+ * Advances the ingame time by several 5 second steps at once.
+ * Only meant to skip steps that would have returned TIME_5SEC,
+ * so it must stay below getStepsToNextTrigger().
+ * @param steps Number of 5 second steps.
+ */
+void GameTime::skipSteps(int steps)
+{
+	int seconds = _second + steps * 5;
+	_minute += seconds / 60;
+	_second = seconds % 60;
+}
+
 /**
  * Returns the current ingame second.
  * @return Second (0-59).
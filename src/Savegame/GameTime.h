@@ -50,6 +50,10 @@ public:
 	YAML::Node save() const;
 	/// Advances the time by 5 seconds.
 	TimeTrigger advance();
+	/// Gets the number of 5 second steps until the next 10 minute trigger.
+	int getStepsToNextTrigger() const;
+	/// Advances the time by several 5 second steps without any trigger.
+	void skipSteps(int steps);
 	/// Gets the ingame second.
 	int getSecond() const;
 	/// Gets the ingame minute.
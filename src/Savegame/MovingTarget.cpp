@@ -16,6 +16,7 @@
  * You should have received a copy of the GNU General Public License
  * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include "MovingTarget.h"
 #include "../fmath.h"
 #include "SerializationHelper.h"
@@ -159,6 +160,44 @@ void MovingTarget::setSpeed(int speed)
 	calculateSpeed();
 }
 
+/**
+ * Gets the point reached by going an angle along the great circle from
+ * one point towards another, so any point of a straight flight can be
+ * found directly instead of by adding up steps.
+ * @param lon1 Longitude of the start point.
+ * @param lat1 Latitude of the start point.
+ * @param lon2 Longitude of the end point.
+ * @param lat2 Latitude of the end point.
+ * @param angle Angle to go, in radians. Going past the end point returns the end point.
+ * @param lon Resulting longitude.
+ * @param lat Resulting latitude.
+ * @return False if the points are the same or opposite, where the great circle isn't defined.
+ */
+bool MovingTarget::getGreatCirclePoint(double lon1, double lat1, double lon2, double lat2, double angle, double &lon, double &lat)
+{
+	double x1 = cos(lat1) * cos(lon1), y1 = cos(lat1) * sin(lon1), z1 = sin(lat1);
+	double x2 = cos(lat2) * cos(lon2), y2 = cos(lat2) * sin(lon2), z2 = sin(lat2);
+	double distance = acos(Clamp(x1 * x2 + y1 * y2 + z1 * z2, -1.0, 1.0));
+	if (angle >= distance)
+	{
+		lon = lon2;
+		lat = lat2;
+		return true;
+	}
+	double sinDistance = sin(distance);
+	if (sinDistance < 1e-9)
+	{
+		return false;
+	}
+	// spherical interpolation between the two points
+	double a = sin(distance - angle) / sinDistance;
+	double b = sin(angle) / sinDistance;
+	double x = a * x1 + b * x2, y = a * y1 + b * y2, z = a * z1 + b * z2;
+	lon = atan2(y, x);
+	lat = asin(Clamp(z, -1.0, 1.0));
+	return true;
+}
+
 /**
  * Calculates the speed vector based on the
  * great circle distance to destination and
@@ -213,8 +252,18 @@ void MovingTarget::move()
 	{
 		if (getDistance(_dest) > _speedRadian)
 		{
-			setLongitude(_lon + _speedLon);
-			setLatitude(_lat + _speedLat);
+			// follow the great circle to the meeting point exactly, the speed vector only approximates it
+			double lon, lat;
+			if (getGreatCirclePoint(_lon, _lat, _meetPointLon, _meetPointLat, _speedRadian, lon, lat))
+			{
+				setLongitude(lon);
+				setLatitude(lat);
+			}
+			else
+			{
+				setLongitude(_lon + _speedLon);
+				setLatitude(_lat + _speedLat);
+			}
 		}
 		else
 		{
@@ -224,6 +273,53 @@ void MovingTarget::move()
 	}
 }
 
+/**
+ * Gets how many calls to move() it takes to reach the destination,
+ * when the destination doesn't move, as every move follows the same
+ * great circle by the same angle.
+ * @return Number of moves, 0 if already there, -1 if it never gets there.
+ */
+int MovingTarget::getStepsToDestination() const
+{
+	if (_dest == 0)
+	{
+		return -1;
+	}
+	if (reachedDestination())
+	{
+		return 0;
+	}
+	if (_speedRadian <= 0.0)
+	{
+		return -1;
+	}
+	return std::max(1, (int)ceil(getDistance(_dest) / _speedRadian));
+}
+
+/**
+ * Moves towards a destination that doesn't move by several steps at once,
+ * ending where that many calls to move() would.
+ * @param steps Number of moves, less than getStepsToDestination().
+ */
+void MovingTarget::moveSteps(int steps)
+{
+	calculateSpeed();
+	double lon, lat;
+	if (_dest != 0 && steps > 0 && getGreatCirclePoint(_lon, _lat, _meetPointLon, _meetPointLat, _speedRadian * steps, lon, lat))
+	{
+		setLongitude(lon);
+		setLatitude(lat);
+		calculateSpeed();
+	}
+	else
+	{
+		for (int i = 0; i < steps; ++i)
+		{
+			move();
+		}
+	}
+}
+
 /**
  * Calculate meeting point with the target.
  */
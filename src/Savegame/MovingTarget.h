@@ -40,6 +40,8 @@ protected:
 	virtual void calculateSpeed();
 	/// Converts a speed to radians.
 	static double calculateRadianSpeed(int speed);
+	/// Gets the point some way along the great circle between two points.
+	static bool getGreatCirclePoint(double lon1, double lat1, double lon2, double lat2, double angle, double &lon, double &lat);
 	/// Creates a moving target.
 	MovingTarget();
 public:
@@ -63,6 +65,10 @@ public:
 	bool reachedDestination() const;
 	/// Move towards the destination.
 	void move();
+	/// Gets the number of moves it takes to reach a destination that stays put.
+	int getStepsToDestination() const;
+	/// Moves several steps towards a destination that stays put at once.
+	void moveSteps(int steps);
 	/// Calculate meeting point with the target.
 	void calculateMeetPoint();
 	/// Returns the latitude of the meeting point
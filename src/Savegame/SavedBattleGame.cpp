@@ -18,6 +18,8 @@
  */
 #include <assert.h>
 #include <vector>
+#include <algorithm>
+#include <climits>
 #include "BattleItem.h"
 #include "SavedBattleGame.h"
 #include "SavedGame.h"
@@ -34,6 +36,8 @@
 #include "../Mod/Mod.h"
 #include "../Mod/Armor.h"
 #include "../Engine/Game.h"
+#include "../Engine/Screen.h"
+#include "../Engine/ThreadPool.h"
 #include "../Mod/RuleInventory.h"
 #include "../Battlescape/AIModule.h"
 #include "../Engine/RNG.h"
@@ -534,11 +538,13 @@ void SavedBattleGame::initMap(int mapsize_x, int mapsize_y, int mapsize_z, bool
 
 	_tiles.clear();
 	_tiles.reserve(_mapsize_z * _mapsize_y * _mapsize_x);
+	// tiles keep pointers into this, so it is never resized while they exist
+	_tileHotData.assign(_mapsize_z * _mapsize_y * _mapsize_x, TileHotData{});
 	for (int i = 0; i < _mapsize_z * _mapsize_y * _mapsize_x; ++i)
 	{
 		Position pos;
 		getTileCoords(i, &pos.x, &pos.y, &pos.z);
-		_tiles.push_back(Tile(pos));
+		_tiles.push_back(Tile(pos, &_tileHotData[i]));
 	}
 
 }
@@ -1494,10 +1500,13 @@ Node *SavedBattleGame::getSpawnNode(int nodeRank, BattleUnit *unit)
  * @param scout Is the unit scouting?
  * @param unit Pointer to the unit (to get its position).
  * @param fromNode Pointer to the node the unit is at.
+ * @param reachable Set to true if the unit is known to reach the chosen node within one turn.
  * @return Pointer to the chosen node.
  */
-Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode)
+Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode, bool *reachable)
 {
+	std::vector<Node *> candidateNodes;
+	std::vector<Position> candidatePositions;
 	std::vector<Node *> compliantNodes;
 	Node *preferred = 0;
 
@@ -1530,6 +1539,22 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 			&& (unit->getFaction() != FACTION_HOSTILE || !getTile(n->getPosition())->getDangerous())	// aliens don't run into a grenade blast
 			&& (!scout || n != fromNode)																// scouts push forward
 			&& n->getPosition().x > 0 && n->getPosition().y > 0)
+		{
+			candidateNodes.push_back(n);
+			candidatePositions.push_back(n->getPosition());
+		}
+	}
+
+	// drop the nodes the unit can't walk to, one search from the unit checks all of them;
+	// it only goes as far as a turn of walking, nodes further away are left to the caller
+	const int maxTUCost = unit->getBaseStats()->tu;
+	std::vector<int> costs = getPathfinding()->findCostsTo(unit, candidatePositions, maxTUCost);
+	std::vector<int> compliantCosts;
+	int preferredCost = -1;
+	for (size_t i = 0; i < candidateNodes.size(); ++i)
+	{
+		Node *n = candidateNodes[i];
+		if (costs[i] != -1)
 		{
 			if (!preferred
 				|| (unit->getRankInt() >=0 &&
@@ -1538,17 +1563,23 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 				|| preferred->getFlags() < n->getFlags())
 			{
 				preferred = n;
+				preferredCost = costs[i];
 			}
 			compliantNodes.push_back(n);
+			compliantCosts.push_back(costs[i]);
 		}
 	}
 
+	if (reachable)
+	{
+		*reachable = false;
+	}
 	if (compliantNodes.empty())
 	{
 		if (Options::traceAI) { Log(LOG_INFO) << (scout ? "Scout " : "Guard") << " found on patrol node! XXX XXX XXX"; }
 		if (unit->getArmor()->getSize() > 1 && !scout)
 		{
-			return getPatrolNode(true, unit, fromNode); // move dammit
+			return getPatrolNode(true, unit, fromNode, reachable); // move dammit
 		}
 		else
 			return 0;
@@ -1557,7 +1588,12 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 	if (scout)
 	{
 		// scout picks a random destination:
-		return compliantNodes[RNG::generate(0, compliantNodes.size() - 1)];
+		int n = RNG::generate(0, compliantNodes.size() - 1);
+		if (reachable)
+		{
+			*reachable = compliantCosts[n] <= maxTUCost;
+		}
+		return compliantNodes[n];
 	}
 	else
 	{
@@ -1565,22 +1601,63 @@ Node *SavedBattleGame::getPatrolNode(bool scout, BattleUnit *unit, Node *fromNod
 
 		// non-scout patrols to highest value unoccupied node that's not fromNode
 		if (Options::traceAI) { Log(LOG_INFO) << "Choosing node flagged " << preferred->getFlags(); }
+		if (reachable)
+		{
+			*reachable = preferredCost <= maxTUCost;
+		}
 		return preferred;
 	}
 }
 
 /**
- * Carries out new turn preparations such as fire and smoke spreading.
+ * Burns a tile whose fire went out, and any object in it,
+ * if it's not fireproof/indestructible.
+ * @param tile Tile that burnt out.
  */
-void SavedBattleGame::prepareNewTurn()
+void SavedBattleGame::burnTile(Tile *tile)
+{
+	if (tile->getMapData(O_OBJECT))
+	{
+		if (tile->getMapData(O_OBJECT)->getFlammable() != 255 && tile->getMapData(O_OBJECT)->getArmor() != 255)
+		{
+			if (tile->destroy(O_OBJECT, getObjectiveType()))
+			{
+				addDestroyedObjective();
+			}
+			if (tile->destroy(O_FLOOR, getObjectiveType()))
+			{
+				addDestroyedObjective();
+			}
+		}
+	}
+	else if (tile->getMapData(O_FLOOR))
+	{
+		if (tile->getMapData(O_FLOOR)->getFlammable() != 255 && tile->getMapData(O_FLOOR)->getArmor() != 255)
+		{
+			if (tile->destroy(O_FLOOR, getObjectiveType()))
+			{
+				addDestroyedObjective();
+			}
+		}
+	}
+	getTileEngine()->applyGravity(tile);
+}
+
+/**
+ * Spreads fire and smoke for a new turn by going through the burning
+ * and smoking tiles in map order, changing their neighbours in place.
+ * The random numbers are drawn from the game's generator in that order.
+ * @return True if any tile was on fire or smoking.
+ */
+bool SavedBattleGame::spreadFireAndSmoke()
 {
 	std::vector<Tile*> tilesOnFire;
 	std::vector<Tile*> tilesOnSmoke;
 
-	// prepare a list of tiles on fire
+	// prepare a list of tiles on fire, the scans over the whole map only read the dense tile data
 	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
 	{
-		if (getTile(i)->getFire() > 0)
+		if (_tileHotData[i].fire > 0)
 		{
 			tilesOnFire.push_back(getTile(i));
 		}
@@ -1616,32 +1693,7 @@ void SavedBattleGame::prepareNewTurn()
 			else
 			{
 				(*i)->setSmoke(0);
-				// burn this tile, and any object in it, if it's not fireproof/indestructible.
-				if ((*i)->getMapData(O_OBJECT))
-				{
-					if ((*i)->getMapData(O_OBJECT)->getFlammable() != 255 && (*i)->getMapData(O_OBJECT)->getArmor() != 255)
-					{
-						if ((*i)->destroy(O_OBJECT, getObjectiveType()))
-						{
-							addDestroyedObjective();
-						}
-						if ((*i)->destroy(O_FLOOR, getObjectiveType()))
-						{
-							addDestroyedObjective();
-						}
-					}
-				}
-				else if ((*i)->getMapData(O_FLOOR))
-				{
-					if ((*i)->getMapData(O_FLOOR)->getFlammable() != 255 && (*i)->getMapData(O_FLOOR)->getArmor() != 255)
-					{
-						if ((*i)->destroy(O_FLOOR, getObjectiveType()))
-						{
-							addDestroyedObjective();
-						}
-					}
-				}
-				getTileEngine()->applyGravity(*i);
+				burnTile(*i);
 			}
 		}
 	}
@@ -1649,12 +1701,13 @@ void SavedBattleGame::prepareNewTurn()
 	// prepare a list of tiles on fire/with smoke in them (smoke acts as fire intensity)
 	for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
 	{
-		if (getTile(i)->getSmoke() > 0)
+		if (_tileHotData[i].smoke > 0)
 		{
 			tilesOnSmoke.push_back(getTile(i));
 		}
-		getTile(i)->setDangerous(false);
+		_tileHotData[i].danger = false;
 	}
+	getTileEngine()->getInfluenceMap()->clearDanger();
 
 	// now make the smoke spread.
 	for (std::vector<Tile*>::iterator i = tilesOnSmoke.begin(); i != tilesOnSmoke.end(); ++i)
@@ -1708,12 +1761,304 @@ void SavedBattleGame::prepareNewTurn()
 		}
 	}
 
-	if (!tilesOnFire.empty() || !tilesOnSmoke.empty())
+	return !tilesOnFire.empty() || !tilesOnSmoke.empty();
+}
+
+namespace
+{
+
+/**
+ * Gets a random number for a tile in a buffered fire and smoke step.
+ * It only depends on the seed of the step, the tile and the draw,
+ * so it is the same whatever order or thread the tiles are worked on.
+ * @param seed Seed of the step.
+ * @param index Tile index.
+ * @param draw Which number of the tile this is.
+ * @return Random number.
+ */
+Uint64 tileRandom(Uint64 seed, int index, int draw)
+{
+	Uint64 z = seed + (Uint64)(index * 8 + draw + 1) * 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * One step of fire or smoke over the whole map. Every tile reads the
+ * state of itself and its neighbours from the start of the step and
+ * only writes its own next state, so the tiles can be worked on in
+ * any order and split across threads.
+ */
+struct FireSpreadStep
+{
+	SavedBattleGame *save;
+	Uint64 seed;
+	int size, parts;
+	/// state at the start of the step
+	std::vector<int> fire, smoke, overlaps;
+	/// state after the step, and the new animation offset or -1
+	std::vector<int> nextFire, nextSmoke, nextOverlaps, animation;
+	std::vector<Uint8> burntOut;
+
+	/// Copies the fire and smoke of the map.
+	void read(const std::vector<TileHotData> &hot)
+	{
+		fire.assign(size, 0);
+		smoke.assign(size, 0);
+		overlaps.assign(size, 0);
+		for (int i = 0; i < size; ++i)
+		{
+			fire[i] = hot[i].fire;
+			smoke[i] = hot[i].smoke;
+			// only tiles with fire or smoke can have overlaps left from this turn
+			if (fire[i] != 0 || smoke[i] != 0)
+			{
+				overlaps[i] = save->getTile(i)->getOverlaps();
+			}
+		}
+		nextFire = fire;
+		nextSmoke = smoke;
+		nextOverlaps = overlaps;
+		animation.assign(size, -1);
+		burntOut.assign(size, 0);
+	}
+
+	/// Gets the neighbour of a tile in a direction, and its index.
+	Tile *neighbour(Tile *tile, Position vector, int &index) const
+	{
+		Tile *t = save->getTile(tile->getPosition() + vector);
+		if (t)
+		{
+			index = save->getTileIndex(t->getPosition());
+		}
+		return t;
+	}
+
+	/**
+	 * Burns down a tile or lets the burning tiles around set it on fire,
+	 * with the same rules as the in-place spread.
+	 */
+	void spreadFire(int i)
+	{
+		Tile *tile = save->getTile(i);
+		if (fire[i] > 0)
+		{
+			// fire added this turn doesn't burn down yet
+			if (overlaps[i] == 0)
+			{
+				nextFire[i] = fire[i] - 1;
+				if (nextFire[i] == 0)
+				{
+					nextSmoke[i] = 0;
+					burntOut[i] = 1;
+				}
+				animation[i] = tileRandom(seed, i, 0) % 4;
+			}
+			return;
+		}
+		const int flammability = tile->getFlammability();
+		const int fuel = tile->getFuel();
+		if (flammability == 255 || fuel == 0)
+		{
+			return;
+		}
+		// burning tiles in the four cardinal directions that are still burning after this turn
+		for (int dir = 0; dir <= 6; dir += 2)
+		{
+			Position vector;
+			Pathfinding::directionToVector(dir, &vector);
+			int j = 0;
+			Tile *t = neighbour(tile, Position(0, 0, 0) - vector, j);
+			if (t && fire[j] > 1 && overlaps[j] == 0 && save->getTileEngine()->horizontalBlockage(t, tile, DT_IN) == 0)
+			{
+				int power = std::max(0, smoke[j] - flammability / 10 + 15);
+				if ((int)(tileRandom(seed, i, 1 + dir / 2) % 100) < power)
+				{
+					nextSmoke[i] = 15 - std::max(1, std::min(flammability / 10, 12));
+					nextOverlaps[i] = 1;
+					nextFire[i] = fuel + 1;
+					animation[i] = tileRandom(seed, i, 0) % 4;
+					return;
+				}
+			}
+		}
+	}
+
+	/// Adds smoke to a tile like Tile::addSmoke() does.
+	void addSmoke(int i, int amount)
+	{
+		if (nextOverlaps[i] == 0)
+		{
+			nextSmoke[i] = std::max(1, std::min(nextSmoke[i] + amount, 15));
+		}
+		else
+		{
+			nextSmoke[i] += amount;
+		}
+		++nextOverlaps[i];
+		animation[i] = tileRandom(seed, i, 0) % 4;
+	}
+
+	/**
+	 * Thins out the smoke of a tile and gathers the smoke drifting in
+	 * from its neighbours, with the same rules as the in-place spread.
+	 */
+	void spreadSmoke(int i)
+	{
+		// burning tiles keep their smoke and don't take any more
+		if (fire[i] != 0)
+		{
+			return;
+		}
+		Tile *tile = save->getTile(i);
+		if (smoke[i] > 0)
+		{
+			nextSmoke[i] = smoke[i] - 1;
+			animation[i] = tileRandom(seed, i, 0) % 4;
+		}
+		// smoke from a fire below rises if there's no floor blocking it
+		int j = 0;
+		Tile *t = neighbour(tile, Position(0, 0, -1), j);
+		if (t && fire[j] > 0 && smoke[j] > 0 && tile->hasNoFloor(t))
+		{
+			addSmoke(i, smoke[j] / 2);
+		}
+		for (int dir = 0; dir <= 6; dir += 2)
+		{
+			Position vector;
+			Pathfinding::directionToVector(dir, &vector);
+			t = neighbour(tile, Position(0, 0, 0) - vector, j);
+			if (!t || smoke[j] == 0 || save->getTileEngine()->horizontalBlockage(t, tile, DT_SMOKE) != 0)
+			{
+				continue;
+			}
+			if (fire[j] > 0)
+			{
+				// burning tiles give off half their smoke
+				addSmoke(i, smoke[j] / 2);
+			}
+			else if (smoke[j] > 1 && (smoke[i] == 0 || nextOverlaps[i] != 0))
+			{
+				// other smoke only drifts into clear tiles, or tiles that got smoke this turn
+				addSmoke(i, smoke[j] - 1);
+			}
+		}
+	}
+
+	/// Works on a part of the map for the fire.
+	static void fireJob(void *data, int part)
+	{
+		FireSpreadStep *step = (FireSpreadStep*)data;
+		for (int i = step->size * part / step->parts; i < step->size * (part + 1) / step->parts; ++i)
+		{
+			step->spreadFire(i);
+		}
+	}
+
+	/// Works on a part of the map for the smoke.
+	static void smokeJob(void *data, int part)
+	{
+		FireSpreadStep *step = (FireSpreadStep*)data;
+		for (int i = step->size * part / step->parts; i < step->size * (part + 1) / step->parts; ++i)
+		{
+			step->spreadSmoke(i);
+		}
+	}
+
+	/// Writes the next state to the tiles that changed.
+	void write()
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			if (animation[i] != -1 || nextFire[i] != fire[i] || nextSmoke[i] != smoke[i] || nextOverlaps[i] != overlaps[i])
+			{
+				Tile *tile = save->getTile(i);
+				tile->setFireAndSmoke(nextFire[i], nextSmoke[i], nextOverlaps[i], animation[i] != -1 ? animation[i] : tile->getAnimationOffset());
+			}
+		}
+	}
+};
+
+}
+
+/**
+ * Spreads fire and smoke for a new turn as two steps over the whole map,
+ * one for fire and one for smoke, which read the map as it was before the
+ * step and write the result to a second buffer. The steps are split across
+ * the render threads, and each tile draws its random numbers from its own
+ * stream seeded once per turn, so the result doesn't depend on the order
+ * or the number of threads, but it isn't the same as spreadFireAndSmoke().
+ * @return True if any tile was on fire or smoking.
+ */
+bool SavedBattleGame::spreadFireAndSmokeBuffered()
+{
+	ThreadPool *pool = getBattleState()->getGame()->getScreen()->getThreadPool();
+	FireSpreadStep step;
+	step.save = this;
+	step.seed = ((Uint64)RNG::generate(0, INT_MAX) << 32) ^ (Uint64)RNG::generate(0, INT_MAX);
+	step.size = _mapsize_x * _mapsize_y * _mapsize_z;
+	step.parts = pool ? pool->getThreads() * 4 : 1;
+
+	// first: fires burn down and spread
+	step.read(_tileHotData);
+	bool spread = std::find_if(step.fire.begin(), step.fire.end(), [](int fire) { return fire > 0; }) != step.fire.end();
+	if (spread)
+	{
+		if (pool)
+		{
+			pool->run(FireSpreadStep::fireJob, &step, step.parts);
+		}
+		else
+		{
+			FireSpreadStep::fireJob(&step, 0);
+		}
+		step.write();
+		for (int i = 0; i < step.size; ++i)
+		{
+			if (step.burntOut[i])
+			{
+				burnTile(getTile(i));
+			}
+		}
+	}
+
+	for (int i = 0; i < step.size; ++i)
+	{
+		_tileHotData[i].danger = false;
+	}
+	getTileEngine()->getInfluenceMap()->clearDanger();
+
+	// now make the smoke spread.
+	step.read(_tileHotData);
+	if (std::find_if(step.smoke.begin(), step.smoke.end(), [](int smoke) { return smoke > 0; }) != step.smoke.end())
+	{
+		spread = true;
+		if (pool)
+		{
+			pool->run(FireSpreadStep::smokeJob, &step, step.parts);
+		}
+		else
+		{
+			FireSpreadStep::smokeJob(&step, 0);
+		}
+		step.write();
+	}
+	return spread;
+}
+
+/**
+ * Carries out new turn preparations such as fire and smoke spreading.
+ */
+void SavedBattleGame::prepareNewTurn()
+{
+	bool spread = Options::bufferedFireSpread ? spreadFireAndSmokeBuffered() : spreadFireAndSmoke();
+	if (spread)
 	{
 		// do damage to units, average out the smoke, etc.
 		for (int i = 0; i < _mapsize_x * _mapsize_y * _mapsize_z; ++i)
 		{
-			if (getTile(i)->getSmoke() != 0)
+			if (_tileHotData[i].smoke != 0)
 				getTile(i)->prepareNewTurn(getDepth() == 0);
 		}
 	}
@@ -59,6 +59,7 @@ private:
 	int _mapsize_x, _mapsize_y, _mapsize_z;
 	std::vector<MapDataSet*> _mapDataSets;
 	std::vector<Tile> _tiles;
+	std::vector<TileHotData> _tileHotData;
 	BattleUnit *_selectedUnit, *_lastSelectedUnit;
 	std::vector<Node*> _nodes;
 	std::vector<BattleUnit*> _units;
@@ -182,6 +183,16 @@ public:
 	{
 		return &_tiles[i];
 	}
+
+	/**
+	 * Gets the frequently used fields of a tile, stored densely apart from the tiles.
+	 * @param i Index position, less than `getMapSizeXYZ()`.
+	 * @return Pointer to the data of the tile at that index.
+	 */
+	TileHotData* getTileHotData(int i)
+	{
+		return &_tileHotData[i];
+	}
 	/// Gets the currently selected unit.
 	BattleUnit *getSelectedUnit() const;
 	/// Sets the currently selected unit.
@@ -251,7 +262,13 @@ public:
 	/// Gets a spawn node.
 	Node *getSpawnNode(int nodeRank, BattleUnit *unit);
 	/// Gets a patrol node.
-	Node *getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode);
+	Node *getPatrolNode(bool scout, BattleUnit *unit, Node *fromNode, bool *reachable = 0);
+	/// Burns a tile whose fire went out.
+	void burnTile(Tile *tile);
+	/// Spreads fire and smoke in place, in map order.
+	bool spreadFireAndSmoke();
+	/// Spreads fire and smoke with buffered steps over the whole map.
+	bool spreadFireAndSmokeBuffered();
 	/// Carries out new turn preparations.
 	void prepareNewTurn();
 	/// Revives unconscious units (healthcheck).
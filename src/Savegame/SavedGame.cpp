@@ -53,6 +53,7 @@
 #include "AlienStrategy.h"
 #include "AlienMission.h"
 #include "../Mod/RuleRegion.h"
+#include "../Mod/RuleCountry.h"
 #include "BaseFacility.h"
 #include "MissionStatistics.h"
 #include "SoldierDeath.h"
@@ -1853,14 +1854,46 @@ private:
 	double _lon, _lat;
 };
 
+/**
+ * Refills an area lookup if the list of areas it was made from
+ * or the lookup resolution option changed.
+ * @param lookup Lookup to check.
+ * @param areas Regions or countries, in the order to find them in.
+ */
+template <typename T>
+void updateLookup(AreaLookup &lookup, const std::vector<T*> &areas)
+{
+	if (lookup.isBuilt() && lookup.getAreas() == (int)areas.size() && lookup.getResolution() == Options::geoLookupResolution)
+	{
+		return;
+	}
+	lookup.clear();
+	for (typename std::vector<T*>::const_iterator i = areas.begin(); i != areas.end(); ++i)
+	{
+		lookup.addArea((*i)->getRules()->getLonMin(), (*i)->getRules()->getLonMax(), (*i)->getRules()->getLatMin(), (*i)->getRules()->getLatMax());
+	}
+	lookup.build(Options::geoLookupResolution);
+}
+
 /**
  * Find the region containing this location.
+ * Only locations on region borders have to test the regions one by one.
  * @param lon The longtitude.
  * @param lat The latitude.
  * @return Pointer to the region, or 0.
  */
 Region *SavedGame::locateRegion(double lon, double lat) const
 {
+	updateLookup(_regionLookup, _regions);
+	int area = _regionLookup.find(lon, lat);
+	if (area >= 0)
+	{
+		return _regions[area];
+	}
+	if (area == AreaLookup::NONE)
+	{
+		return 0;
+	}
 	std::vector<Region *>::const_iterator found = std::find_if (_regions.begin(), _regions.end(), ContainsPoint(lon, lat));
 	if (found != _regions.end())
 	{
@@ -1879,6 +1912,45 @@ Region *SavedGame::locateRegion(const Target &target) const
 	return locateRegion(target.getLongitude(), target.getLatitude());
 }
 
+/**
+ * Find the country containing this location.
+ * Only locations on country borders have to test the countries one by one.
+ * @param lon The longtitude.
+ * @param lat The latitude.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(double lon, double lat) const
+{
+	updateLookup(_countryLookup, _countries);
+	int area = _countryLookup.find(lon, lat);
+	if (area >= 0)
+	{
+		return _countries[area];
+	}
+	if (area == AreaLookup::NONE)
+	{
+		return 0;
+	}
+	for (std::vector<Country*>::const_iterator i = _countries.begin(); i != _countries.end(); ++i)
+	{
+		if ((*i)->getRules()->insideCountry(lon, lat))
+		{
+			return *i;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Find the country containing this target.
+ * @param target The target to locate.
+ * @return Pointer to the country, or 0.
+ */
+Country *SavedGame::locateCountry(const Target &target) const
+{
+	return locateCountry(target.getLongitude(), target.getLatitude());
+}
+
 /*
  * @return the month counter.
  */
@@ -23,6 +23,7 @@
 #include <time.h>
 #include <stdint.h>
 #include "GameTime.h"
+#include "AreaLookup.h"
 #include "../Mod/RuleAlienMission.h"
 #include "../Savegame/Craft.h"
 
@@ -130,6 +131,7 @@ private:
 	size_t _selectedBase;
 	std::string _lastselectedArmor; //contains the last selected armour
 	std::vector<MissionStatistics*> _missionStatistics;
+	mutable AreaLookup _regionLookup, _countryLookup;
 
 	static SaveInfo getSaveInfo(const std::string &file, Language *lang);
 public:
@@ -282,6 +284,10 @@ public:
 	Region *locateRegion(double lon, double lat) const;
 	/// Locate a region containing a Target.
 	Region *locateRegion(const Target &target) const;
+	/// Locate a country containing a position.
+	Country *locateCountry(double lon, double lat) const;
+	/// Locate a country containing a Target.
+	Country *locateCountry(const Target &target) const;
 	/// Return the month counter.
 	int getMonthsPassed() const;
 	/// Return the GraphRegionToggles.
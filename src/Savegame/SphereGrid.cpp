@@ -0,0 +1,131 @@
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SphereGrid.h"
+#include <algorithm>
+#include <cmath>
+#include "../fmath.h"
+
+namespace OpenXcom
+{
+
+/**
+ * Creates an empty grid.
+ * @param cellSize Size of the grid cells, in unit sphere radii.
+ */
+SphereGrid::SphereGrid(double cellSize) : _cellSize(cellSize)
+{
+}
+
+/**
+ *
+ */
+SphereGrid::~SphereGrid()
+{
+}
+
+/**
+ * Packs the coordinates of a grid cell into a key.
+ * @param x Cell X.
+ * @param y Cell Y.
+ * @param z Cell Z.
+ * @return Key of the cell.
+ */
+Uint64 SphereGrid::getKey(int x, int y, int z)
+{
+	return ((Uint64)(x + 0x100000) << 42) | ((Uint64)(y + 0x100000) << 21) | (Uint64)(z + 0x100000);
+}
+
+/**
+ * Gets which row of grid cells a coordinate falls in.
+ * @param v Coordinate, from -1 to 1.
+ * @return Cell index.
+ */
+int SphereGrid::getCell(double v) const
+{
+	return (int)floor(v / _cellSize);
+}
+
+/**
+ * Removes all areas from the grid.
+ */
+void SphereGrid::clear()
+{
+	_cells.clear();
+}
+
+/**
+ * Adds a circular area to every cell that the box around it touches,
+ * leaving out the cells inside or outside the unit sphere. Items have to
+ * be added in increasing order for get() to return them that way.
+ * @param item Number identifying the area.
+ * @param lon Longitude of the center, in radians.
+ * @param lat Latitude of the center, in radians.
+ * @param range Radius of the area, in radians along the globe.
+ */
+void SphereGrid::add(int item, double lon, double lat, double range)
+{
+	// chord of the range, with a bit extra so points right on the edge stay in
+	const double chord = (range >= M_PI ? 2.0 : 2.0 * sin(std::max(range, 0.0) / 2)) + 1e-6;
+	const double cx = cos(lat) * cos(lon), cy = cos(lat) * sin(lon), cz = sin(lat);
+	const int x1 = getCell(std::max(cx - chord, -1.0)), x2 = getCell(std::min(cx + chord, 1.0));
+	const int y1 = getCell(std::max(cy - chord, -1.0)), y2 = getCell(std::min(cy + chord, 1.0));
+	const int z1 = getCell(std::max(cz - chord, -1.0)), z2 = getCell(std::min(cz + chord, 1.0));
+	for (int x = x1; x <= x2; ++x)
+	{
+		const double nearX = std::max(0.0, std::max(x * _cellSize, -(x + 1) * _cellSize));
+		const double farX = std::max(std::abs(x * _cellSize), std::abs((x + 1) * _cellSize));
+		for (int y = y1; y <= y2; ++y)
+		{
+			const double nearY = std::max(0.0, std::max(y * _cellSize, -(y + 1) * _cellSize));
+			const double farY = std::max(std::abs(y * _cellSize), std::abs((y + 1) * _cellSize));
+			for (int z = z1; z <= z2; ++z)
+			{
+				const double nearZ = std::max(0.0, std::max(z * _cellSize, -(z + 1) * _cellSize));
+				const double farZ = std::max(std::abs(z * _cellSize), std::abs((z + 1) * _cellSize));
+				// skip cells the surface of the sphere doesn't go through
+				if (nearX * nearX + nearY * nearY + nearZ * nearZ > 1.0 + 1e-6 || farX * farX + farY * farY + farZ * farZ < 1.0 - 1e-6)
+				{
+					continue;
+				}
+				_cells[getKey(x, y, z)].push_back(item);
+			}
+		}
+	}
+}
+
+/**
+ * Gets the areas that can cover a point, in the order they were added.
+ * Areas not in the list are sure not to cover it, the ones in it still
+ * need to be checked.
+ * @param lon Longitude of the point, in radians.
+ * @param lat Latitude of the point, in radians.
+ * @return List of items.
+ */
+const std::vector<int> &SphereGrid::get(double lon, double lat) const
+{
+	const double x = cos(lat) * cos(lon), y = cos(lat) * sin(lon), z = sin(lat);
+	std::unordered_map<Uint64, std::vector<int> >::const_iterator i = _cells.find(getKey(getCell(x), getCell(y), getCell(z)));
+	if (i == _cells.end())
+	{
+		return _empty;
+	}
+	return i->second;
+}
+
+}
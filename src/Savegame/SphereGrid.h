@@ -0,0 +1,57 @@
+#pragma once
+/*
+ * Copyright 2010-2016 OpenXcom Developers.
+ *
+ * This file is part of OpenXcom.
+ *
+ * OpenXcom is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * OpenXcom is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with OpenXcom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <vector>
+#include <unordered_map>
+#include <SDL_types.h>
+
+namespace OpenXcom
+{
+
+/**
+ * Spatial hash of circular areas on the globe, like radar ranges.
+ * Points are turned into vectors on the unit sphere and each area goes
+ * into every cell of a 3D grid that the box around its circle touches,
+ * so finding the areas that can cover a point only looks at one cell.
+ */
+class SphereGrid
+{
+private:
+	double _cellSize;
+	std::unordered_map<Uint64, std::vector<int> > _cells;
+	std::vector<int> _empty;
+
+	/// Gets the key of a grid cell.
+	static Uint64 getKey(int x, int y, int z);
+	/// Gets the grid cell of a coordinate.
+	int getCell(double v) const;
+public:
+	/// Creates an empty grid.
+	SphereGrid(double cellSize = 0.1);
+	/// Cleans up the grid.
+	~SphereGrid();
+	/// Removes all areas.
+	void clear();
+	/// Adds a circular area.
+	void add(int item, double lon, double lat, double range);
+	/// Gets the areas that can cover a point.
+	const std::vector<int> &get(double lon, double lat) const;
+};
+
+}
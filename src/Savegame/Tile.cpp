@@ -47,9 +47,11 @@ Tile::SerializationKey Tile::serializationKey =
 /**
  * constructor
  * @param pos Position.
+ * @param hot Storage for the frequently used fields, kept by the battle map.
  */
-Tile::Tile(Position pos): _smoke(0), _fire(0), _explosive(0), _explosiveType(0), _pos(pos), _unit(0), _animationOffset(0), _markerColor(0), _visible(false), _preview(-1), _TUMarker(-1), _overlaps(0), _danger(false)
+Tile::Tile(Position pos, TileHotData *hot): _hot(hot), _explosive(0), _explosiveType(0), _pos(pos), _unit(0), _animationOffset(0), _markerColor(0), _preview(-1), _TUMarker(-1), _overlaps(0)
 {
+	*_hot = TileHotData{};
 	for (int i = 0; i < 4; ++i)
 	{
 		_objects[i] = 0;
@@ -57,10 +59,6 @@ Tile::Tile(Position pos): _smoke(0), _fire(0), _explosive(0), _explosiveType(0),
 		_mapDataSetID[i] = -1;
 		_currentFrame[i] = 0;
 	}
-	for (int layer = 0; layer < LL_MAX; layer++)
-	{
-		_light[layer] = 0;
-	}
 	for (int i = 0; i < 3; ++i)
 	{
 		_discovered[i] = false;
@@ -92,8 +90,8 @@ void Tile::load(const YAML::Node &node)
 		_mapDataID[i] = node["mapDataID"][i].as<int>(_mapDataID[i]);
 		_mapDataSetID[i] = node["mapDataSetID"][i].as<int>(_mapDataSetID[i]);
 	}
-	_fire = node["fire"].as<int>(_fire);
-	_smoke = node["smoke"].as<int>(_smoke);
+	_hot->fire = node["fire"].as<int>(_hot->fire);
+	_hot->smoke = node["smoke"].as<int>(_hot->smoke);
 	if (node["discovered"])
 	{
 		for (int i = 0; i < 3; i++)
@@ -109,7 +107,7 @@ void Tile::load(const YAML::Node &node)
 	{
 		_currentFrame[2] = 7;
 	}
-	if (_fire || _smoke)
+	if (_hot->fire || _hot->smoke)
 	{
 		_animationOffset = std::rand() % 4;
 	}
@@ -131,8 +129,8 @@ void Tile::loadBinary(Uint8 *buffer, Tile::SerializationKey& serKey)
 	_mapDataSetID[2] = unserializeInt(&buffer, serKey._mapDataSetID);
 	_mapDataSetID[3] = unserializeInt(&buffer, serKey._mapDataSetID);
 
-	_smoke = unserializeInt(&buffer, serKey._smoke);
-	_fire = unserializeInt(&buffer, serKey._fire);
+	_hot->smoke = unserializeInt(&buffer, serKey._smoke);
+	_hot->fire = unserializeInt(&buffer, serKey._fire);
 
 	Uint8 boolFields = unserializeInt(&buffer, serKey.boolFields);
 	_discovered[0] = (boolFields & 1) ? true : false;
@@ -140,7 +138,7 @@ void Tile::loadBinary(Uint8 *buffer, Tile::SerializationKey& serKey)
 	_discovered[2] = (boolFields & 4) ? true : false;
 	_currentFrame[1] = (boolFields & 8) ? 7 : 0;
 	_currentFrame[2] = (boolFields & 0x10) ? 7 : 0;
-	if (_fire || _smoke)
+	if (_hot->fire || _hot->smoke)
 	{
 		_animationOffset = std::rand() % 4;
 	}
@@ -160,10 +158,10 @@ YAML::Node Tile::save() const
 		node["mapDataID"].push_back(_mapDataID[i]);
 		node["mapDataSetID"].push_back(_mapDataSetID[i]);
 	}
-	if (_smoke)
-		node["smoke"] = _smoke;
-	if (_fire)
-		node["fire"] = _fire;
+	if (_hot->smoke)
+		node["smoke"] = _hot->smoke;
+	if (_hot->fire)
+		node["fire"] = _hot->fire;
 	if (_discovered[O_FLOOR] || _discovered[O_WESTWALL] || _discovered[O_NORTHWALL])
 	{
 		for (int i = O_FLOOR; i <= O_NORTHWALL; i++)
@@ -197,8 +195,8 @@ void Tile::saveBinary(Uint8** buffer) const
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapDataSetID[2]);
 	serializeInt(buffer, serializationKey._mapDataSetID, _mapDataSetID[3]);
 
-	serializeInt(buffer, serializationKey._smoke, _smoke);
-	serializeInt(buffer, serializationKey._fire, _fire);
+	serializeInt(buffer, serializationKey._smoke, _hot->smoke);
+	serializeInt(buffer, serializationKey._fire, _hot->fire);
 
 	Uint8 boolFields = (_discovered[0]?1:0) + (_discovered[1]?2:0) + (_discovered[2]?4:0);
 	boolFields |= isUfoDoorOpen(O_WESTWALL) ? 8 : 0; // west
@@ -218,6 +216,14 @@ void Tile::setMapData(MapData *dat, int mapDataID, int mapDataSetID, TilePart pa
 	_objects[part] = dat;
 	_mapDataID[part] = mapDataID;
 	_mapDataSetID[part] = mapDataSetID;
+
+	int level = 0;
+	if (_objects[O_FLOOR])
+		level = _objects[O_FLOOR]->getTerrainLevel();
+	// whichever's higher, but not the sum.
+	if (_objects[O_OBJECT])
+		level = std::min(_objects[O_OBJECT]->getTerrainLevel(), level);
+	_hot->terrainLevel = level;
 }
 
 /**
@@ -239,7 +245,7 @@ void Tile::getMapData(int *mapDataID, int *mapDataSetID, TilePart part) const
  */
 bool Tile::isVoid() const
 {
-	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _smoke == 0 && _inventory.empty();
+	return _objects[0] == 0 && _objects[1] == 0 && _objects[2] == 0 && _objects[3] == 0 && _hot->smoke == 0 && _inventory.empty();
 }
 
 /**
@@ -289,23 +295,6 @@ bool Tile::isBigWall() const
 		return false;
 }
 
-/**
- * If an object stand on this tile, this returns how high the unit is it standing.
- * @return the level in pixels (so negative values are higher)
- */
-int Tile::getTerrainLevel() const
-{
-	int level = 0;
-
-	if (_objects[O_FLOOR])
-		level = _objects[O_FLOOR]->getTerrainLevel();
-	// whichever's higher, but not the sum.
-	if (_objects[O_OBJECT])
-		level = std::min(_objects[O_OBJECT]->getTerrainLevel(), level);
-
-	return level;
-}
-
 /**
  * Gets the tile's footstep sound.
  * @param tileBelow
@@ -422,7 +411,7 @@ bool Tile::isDiscovered(int part) const
  */
 void Tile::resetLight(LightLayers layer)
 {
-	_light[layer] = 0;
+	_hot->light[layer] = 0;
 }
 
 /**
@@ -431,10 +420,7 @@ void Tile::resetLight(LightLayers layer)
  */
 void Tile::resetLightMulti(LightLayers layer)
 {
-	for (int l = layer; l < LL_MAX; l++)
-	{
-		_light[l] = 0;
-	}
+	_hot->resetLightMulti(layer);
 }
 
 /**
@@ -444,8 +430,7 @@ void Tile::resetLightMulti(LightLayers layer)
  */
 void Tile::addLight(int light, LightLayers layer)
 {
-	if (_light[layer] < light)
-		_light[layer] = light;
+	_hot->addLight(light, layer);
 }
 
 /**
@@ -455,20 +440,12 @@ void Tile::addLight(int light, LightLayers layer)
  */
 int Tile::getLight(LightLayers layer) const
 {
-	return _light[layer];
+	return _hot->light[layer];
 }
 
 int Tile::getLightMulti(LightLayers layer) const
 {
-	int light = 0;
-
-	for (int l = layer; l >= 0; --l)
-	{
-		if (_light[l] > light)
-			light = _light[l];
-	}
-
-	return light;
+	return _hot->getLightMulti(layer);
 }
 
 
@@ -479,15 +456,7 @@ int Tile::getLightMulti(LightLayers layer) const
  */
 int Tile::getShade() const
 {
-	int light = 0;
-
-	for (int layer = 0; layer < LL_MAX; layer++)
-	{
-		if (_light[layer] > light)
-			light = _light[layer];
-	}
-
-	return std::max(0, 15 - light);
+	return std::max(0, 15 - _hot->getLightMulti((LightLayers)(LL_MAX - 1)));
 }
 
 /**
@@ -642,11 +611,11 @@ void Tile::ignite(int power)
 		}
 		if (RNG::percent(power) && getFuel())
 		{
-			if (_fire == 0)
+			if (_hot->fire == 0)
 			{
-				_smoke = 15 - std::max(1, std::min((getFlammability() / 10), 12));
+				_hot->smoke = 15 - std::max(1, std::min((getFlammability() / 10), 12));
 				_overlaps = 1;
-				_fire = getFuel() + 1;
+				_hot->fire = getFuel() + 1;
 				_animationOffset = RNG::generate(0,3);
 			}
 		}
@@ -657,9 +626,11 @@ void Tile::ignite(int power)
  * Animate the tile. This means to advance the current frame for every object.
  * Ufo doors are a bit special, they animated only when triggered.
  * When ufo doors are on frame 0(closed) or frame 7(open) they are not animated further.
+ * @return True if the look of the tile changed.
  */
-void Tile::animate()
+bool Tile::animate()
 {
+	bool changed = false;
 	int newframe;
 	for (int i=0; i < 4; ++i)
 	{
@@ -678,9 +649,17 @@ void Tile::animate()
 			{
 				newframe = 0;
 			}
+			if (_objects[i]->getSprite(newframe) != _objects[i]->getSprite(_currentFrame[i]))
+			{
+				changed = true;
+			}
 			_currentFrame[i] = newframe;
 		}
 	}
+	if (!_particles.empty())
+	{
+		changed = true;
+	}
 	for (std::list<Particle*>::iterator i = _particles.begin(); i != _particles.end();)
 	{
 		if (!(*i)->animate())
@@ -693,6 +672,7 @@ void Tile::animate()
 			++i;
 		}
 	}
+	return changed;
 }
 
 /**
@@ -728,7 +708,7 @@ void Tile::setUnit(BattleUnit *unit, Tile *tileBelow)
  */
 void Tile::setFire(int fire)
 {
-	_fire = fire;
+	_hot->fire = fire;
 	_animationOffset = RNG::generate(0,3);
 }
 
@@ -738,7 +718,7 @@ void Tile::setFire(int fire)
  */
 int Tile::getFire() const
 {
-	return _fire;
+	return _hot->fire;
 }
 
 /**
@@ -747,15 +727,15 @@ int Tile::getFire() const
  */
 void Tile::addSmoke(int smoke)
 {
-	if (_fire == 0)
+	if (_hot->fire == 0)
 	{
 		if (_overlaps == 0)
 		{
-			_smoke = std::max(1, std::min(_smoke + smoke, 15));
+			_hot->smoke = std::max(1, std::min(_hot->smoke + smoke, 15));
 		}
 		else
 		{
-			_smoke += smoke;
+			_hot->smoke += smoke;
 		}
 		_animationOffset = RNG::generate(0,3);
 		addOverlap();
@@ -768,7 +748,7 @@ void Tile::addSmoke(int smoke)
  */
 void Tile::setSmoke(int smoke)
 {
-	_smoke = smoke;
+	_hot->smoke = smoke;
 	_animationOffset = RNG::generate(0,3);
 }
 
@@ -779,7 +759,7 @@ void Tile::setSmoke(int smoke)
  */
 int Tile::getSmoke() const
 {
-	return _smoke;
+	return _hot->smoke;
 }
 
 /**
@@ -877,17 +857,17 @@ static inline void applyEnvi(BattleUnit* unit, int smoke, int fire, bool smokeDa
 void Tile::prepareNewTurn(bool smokeDamage)
 {
 	// we've received new smoke in this turn, but we're not on fire, average out the smoke.
-	if ( _overlaps != 0 && _smoke != 0 && _fire == 0)
+	if ( _overlaps != 0 && _hot->smoke != 0 && _hot->fire == 0)
 	{
-		_smoke = std::max(0, std::min((_smoke / _overlaps)- 1, 15));
+		_hot->smoke = std::max(0, std::min((_hot->smoke / _overlaps)- 1, 15));
 	}
 	// if we still have smoke/fire
-	if (_smoke)
+	if (_hot->smoke)
 	{
-		applyEnvi(_unit, _smoke, _fire, smokeDamage);
+		applyEnvi(_unit, _hot->smoke, _hot->fire, smokeDamage);
 		for (std::vector<BattleItem*>::iterator i = _inventory.begin(); i != _inventory.end(); ++i)
 		{
-			applyEnvi((*i)->getUnit(), _smoke, _fire, smokeDamage);
+			applyEnvi((*i)->getUnit(), _hot->smoke, _hot->fire, smokeDamage);
 		}
 	}
 	_overlaps = 0;
@@ -927,7 +907,7 @@ int Tile::getMarkerColor() const
  */
 void Tile::setVisible(int visibility)
 {
-	_visible += visibility;
+	_hot->visible += visibility;
 }
 
 /**
@@ -936,7 +916,7 @@ void Tile::setVisible(int visibility)
  */
 int Tile::getVisible() const
 {
-	return _visible;
+	return _hot->visible;
 }
 
 /**
@@ -992,12 +972,28 @@ void Tile::addOverlap()
 	++_overlaps;
 }
 
+/**
+ * Sets the fire, smoke and overlaps of this tile at once,
+ * as found by a buffered fire and smoke spread step.
+ * @param fire Fire timer.
+ * @param smoke Smoke amount.
+ * @param overlaps Overlap value.
+ * @param animationOffset Fire and smoke animation offset.
+ */
+void Tile::setFireAndSmoke(int fire, int smoke, int overlaps, int animationOffset)
+{
+	_hot->fire = fire;
+	_hot->smoke = smoke;
+	_overlaps = overlaps;
+	_animationOffset = animationOffset;
+}
+
 /**
  * set the danger flag on this tile.
  */
 void Tile::setDangerous(bool danger)
 {
-	_danger = danger;
+	_hot->danger = danger;
 }
 
 /**
@@ -1006,7 +1002,7 @@ void Tile::setDangerous(bool danger)
  */
 bool Tile::getDangerous() const
 {
-	return _danger;
+	return _hot->danger;
 }
 
 /**
@@ -38,6 +38,48 @@ class Particle;
 
 enum LightLayers : Uint8 { LL_AMBIENT, LL_FIRE, LL_ITEMS, LL_UNITS, LL_MAX };
 
+/**
+ * Fields of a tile that lighting, line of sight and map drawing touch in tight loops.
+ * SavedBattleGame keeps them densely in their own array, apart from the rest of the tile.
+ */
+struct TileHotData
+{
+	int light[LL_MAX];
+	int smoke;
+	int fire;
+	int visible;
+	Sint16 terrainLevel;
+	bool danger;
+
+	/// Reset multiple layers of light from defined one.
+	void resetLightMulti(LightLayers layer)
+	{
+		for (int l = layer; l < LL_MAX; l++)
+		{
+			light[l] = 0;
+		}
+	}
+
+	/// Add the light amount to a layer. Only add light if the current light is lower.
+	void addLight(int value, LightLayers layer)
+	{
+		if (light[layer] < value)
+			light[layer] = value;
+	}
+
+	/// Get the brightest light of the given layer and the ones below it.
+	int getLightMulti(LightLayers layer) const
+	{
+		int result = 0;
+		for (int l = layer; l >= 0; --l)
+		{
+			if (light[l] > result)
+				result = light[l];
+		}
+		return result;
+	}
+};
+
 /**
  * Basic element of which a battle map is build.
  * @sa http://www.ufopaedia.org/index.php?title=MAPS
@@ -65,9 +107,7 @@ protected:
 	int _mapDataSetID[4];
 	int _currentFrame[4];
 	bool _discovered[3];
-	int _light[LL_MAX];
-	int _smoke;
-	int _fire;
+	TileHotData *_hot;
 	int _explosive;
 	int _explosiveType;
 	Position _pos;
@@ -75,15 +115,13 @@ protected:
 	std::vector<BattleItem *> _inventory;
 	int _animationOffset;
 	int _markerColor;
-	int _visible;
 	int _preview;
 	int _TUMarker;
 	int _overlaps;
-	bool _danger;
 	std::list<Particle*> _particles;
 public:
 	/// Creates a tile.
-	Tile(Position pos);
+	Tile(Position pos, TileHotData *hot);
 	/// Cleans up a tile.
 	~Tile();
 	/// Load the tile from yaml
@@ -117,8 +155,15 @@ public:
 	bool hasNoFloor(Tile *tileBelow) const;
 	/// Checks if this tile is a big wall.
 	bool isBigWall() const;
-	/// Get terrain level.
-	int getTerrainLevel() const;
+	/**
+	 * If an object stand on this tile, this returns how high the unit is it standing.
+	 * Kept up to date by setMapData().
+	 * @return the level in pixels (so negative values are higher)
+	 */
+	int getTerrainLevel() const
+	{
+		return _hot->terrainLevel;
+	}
 
 	/**
 	 * Gets the tile's position.
@@ -175,7 +220,7 @@ public:
 	/// Get explosive power of this tile.
 	int getExplosiveType() const;
 	/// Animated the tile parts.
-	void animate();
+	bool animate();
 	/// Get object sprites.
 	Surface *getSprite(int part) const;
 	/// Set a unit on this tile.
@@ -240,6 +285,8 @@ public:
 	int getOverlaps() const;
 	/// increment the overlap value on this tile.
 	void addOverlap();
+	/// Set fire, smoke and overlaps found by a buffered spread step.
+	void setFireAndSmoke(int fire, int smoke, int overlaps, int animationOffset);
 	/// set the danger flag on this tile (so the AI will avoid it).
 	void setDangerous(bool danger);
 	/// check the danger flag on this tile.
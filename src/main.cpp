@@ -24,6 +24,9 @@
 #include "Engine/Game.h"
 #include "Engine/Options.h"
 #include "Menu/StartState.h"
+#include "Geoscape/GeoscapeBenchmark.h"
+#include "Battlescape/BattleBenchmark.h"
+#include "Engine/BlitBenchmark.h"
 
 /** @mainpage
  * @author OpenXcom Developers
@@ -120,8 +123,43 @@ int main(int argc, char *argv[])
 	Options::baseXResolution = Options::displayWidth;
 	Options::baseYResolution = Options::displayHeight;
 
+	// the benchmarks don't need a window or sound
+	std::string benchmark = Options::getCommandLine("benchmark");
+	std::string battleBenchmark = Options::getCommandLine("battleBenchmark");
+	std::string blitBenchmark = Options::getCommandLine("blitBenchmark");
+	if (!benchmark.empty() || !battleBenchmark.empty() || !blitBenchmark.empty())
+	{
+		SDL_putenv(const_cast<char*>("SDL_VIDEODRIVER=dummy"));
+		SDL_putenv(const_cast<char*>("SDL_AUDIODRIVER=dummy"));
+	}
+
 	game = new Game(title.str());
 	State::setGamePtr(game);
+	if (!benchmark.empty())
+	{
+		int days = atoi(Options::getCommandLine("benchmarkDays").c_str());
+		GeoscapeBenchmark run(game);
+		int result = run.run(benchmark, days > 0 ? days : 30);
+		delete game;
+		return result;
+	}
+	if (!battleBenchmark.empty())
+	{
+		int seed = atoi(Options::getCommandLine("battleSeed").c_str());
+		int turns = atoi(Options::getCommandLine("battleTurns").c_str());
+		BattleBenchmark run(game);
+		int result = run.run(battleBenchmark, Options::getCommandLine("battleTerrain"), seed, turns > 0 ? turns : 20);
+		delete game;
+		return result;
+	}
+	if (!blitBenchmark.empty())
+	{
+		int rounds = atoi(blitBenchmark.c_str());
+		BlitBenchmark run(game);
+		int result = run.run(rounds > 0 ? rounds : 100);
+		delete game;
+		return result;
+	}
 	game->setState(new StartState);
 	game->run();
 